@@ -0,0 +1,126 @@
+/* Checks that printing to a preallocated buffer does not allocate, counting
+   from the very first print of every type. Exits with a nonzero status if any
+   print allocates. Build it both plain and with -DPRETTY_PRINT_INSTRUMENTATION=1.
+*/
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <new>
+#include <set>
+#include <streambuf>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <valarray>
+#include <vector>
+
+#ifndef PRETTY_PRINT_ATOMIC_RECORDS
+#  define PRETTY_PRINT_ATOMIC_RECORDS 1
+#endif
+
+#include "prettyprint.hpp"
+
+
+/* Counts all heap allocations made by the program. */
+
+static std::atomic<unsigned long> heap_allocations(0);
+
+#if defined(__GNUC__) && !defined(__clang__)
+/* GCC does not see that these replacements belong together. */
+#  pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void * operator new(std::size_t n)
+{
+  ++heap_allocations;
+  if (void * p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void * p) noexcept { std::free(p); }
+void operator delete(void * p, std::size_t) noexcept { std::free(p); }
+
+
+/* A preallocated in-memory sink which just wraps around when full. */
+
+class scratch_sink : public std::streambuf
+{
+public:
+  scratch_sink() { setp(buffer, buffer + sizeof buffer); }
+
+protected:
+  int_type overflow(int_type c)
+  {
+    setp(buffer, buffer + sizeof buffer);
+    return traits_type::not_eof(c);
+  }
+
+private:
+  char buffer[1 << 16];
+};
+
+struct AngleDelims { static const pretty_print::delimiters_values<char> values; };
+const pretty_print::delimiters_values<char> AngleDelims::values = { "<", "; ", ">" };
+
+/* Prints x twice and reports the allocations of each print. */
+
+template <typename T>
+unsigned long report_allocations(const char * name, const T & x, std::ostream & os)
+{
+  unsigned long counts[2];
+  for (unsigned long & count : counts)
+  {
+    const unsigned long before = heap_allocations;
+    os << x;
+    count = heap_allocations - before;
+  }
+
+  std::cout << "  " << name << ": " << counts[0] << ", then " << counts[1] << std::endl;
+  return counts[0] + counts[1];
+}
+
+int main()
+{
+  // Set up before anything is counted: the atomic_records prints below go
+  // through this thread's scratch buffer, which would otherwise grow on the
+  // first of them.
+
+  pretty_print::reserve_scratch(1 << 13);
+
+  scratch_sink sink;
+  std::ostream os(&sink);
+
+  const std::vector<int> v { 1, 2, 3, 4, 5 };
+  const std::map<int, std::string> m { { 1, "one" }, { 2, "two" } };
+  const std::set<int> s { 3, 1, 2 };
+  const std::unordered_map<int, int> um { { 1, 10 }, { 2, 20 } };
+  const std::valarray<double> va { 1.0, -0.5, 0.25 };
+  const int arr[] = { 1, 4, 9, 16 };
+  const std::vector<int> big(1000, 7);
+
+  std::cout << "Heap allocations of the first and second print (to a preallocated sink):" << std::endl;
+  unsigned long total = 0;
+  total += report_allocations("vector", v, os);
+  total += report_allocations("map", m, os);
+  total += report_allocations("set", s, os);
+  total += report_allocations("pair", std::make_pair(1, 2.5), os);
+  total += report_allocations("tuple", std::make_tuple(1, "two", 3.0), os);
+  total += report_allocations("valarray", va, os);
+  total += report_allocations("array_wrapper_n", pretty_print_array(arr, 4), os);
+  total += report_allocations("bucket_print_wrapper", bucket_print(um, um.bucket(1)), os);
+  total += report_allocations("custom_delims", pretty_print::custom_delims<AngleDelims>(v), os);
+
+  os << pretty_print::atomic_records;
+  total += report_allocations("vector, atomic_records", v, os);
+  total += report_allocations("vector(1000), atomic_records", big, os);
+
+  if (total != 0)
+  {
+    std::cout << "  FAILED: " << total << " allocations where none were expected" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
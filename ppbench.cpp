@@ -0,0 +1,822 @@
+/* Benchmarks for prettyprint.hpp and its sinks.
+   Run with an element count, a scratch file name and a random seed,
+   e.g. "ppbench 1000000 /tmp/ppbench.out 42".
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <valarray>
+#include <vector>
+
+#ifndef PRETTY_PRINT_ATOMIC_RECORDS
+#  define PRETTY_PRINT_ATOMIC_RECORDS 1
+#endif
+
+#include "prettyprint.hpp"
+#include "prettyprint_cache.hpp"
+#include "prettyprint_dataset.hpp"
+#include "prettyprint_sinks.hpp"
+
+#ifdef __linux__
+#  include <cerrno>
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+
+/* Runs f once and returns the elapsed wall time in milliseconds. */
+
+template <typename F>
+double time_ms(F f)
+{
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename T>
+void bench_file_sinks(const T & data, const char * path)
+{
+  const double t_ofstream = time_ms([&] {
+    std::ofstream os(path);
+    os << data;
+  });
+
+  const double t_pipelined = time_ms([&] {
+    pretty_print::pipelined_filebuf buf(path);
+    std::ostream os(&buf);
+    os << data;
+    buf.close();
+  });
+
+  const double t_direct = time_ms([&] {
+    pretty_print::pipelined_filebuf buf(path, pretty_print::pipelined_filebuf::default_buffer_size, true);
+    std::ostream os(&buf);
+    os << data;
+    buf.close();
+  });
+
+  std::cout << "File dump:" << std::endl
+            << "  std::ofstream:              " << t_ofstream << " ms" << std::endl
+            << "  pipelined_filebuf:          " << t_pipelined << " ms" << std::endl
+            << "  pipelined_filebuf (direct): " << t_direct << " ms" << std::endl;
+}
+
+
+/* An unbuffered, mutex-protected file buffer standing in for a shared stream
+   such as a synchronized std::cout. It counts how often its lock is taken. */
+
+class locked_filebuf : public std::streambuf
+{
+public:
+  explicit locked_filebuf(const char * path) : locks(0) { file.open(path, std::ios_base::out | std::ios_base::trunc); }
+
+  std::atomic<unsigned long> locks;
+
+protected:
+  int_type overflow(int_type c)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++locks;
+    return file.sputc(traits_type::to_char_type(c));
+  }
+
+  std::streamsize xsputn(const char * p, std::streamsize n)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++locks;
+    return file.sputn(p, n);
+  }
+
+private:
+  std::mutex mutex;
+  std::filebuf file;
+};
+
+void bench_contention(std::size_t n, const char * path, bool atomic)
+{
+  const unsigned threads = std::max(4u, std::thread::hardware_concurrency());
+  const std::vector<int> record { 1, 22, 333, 4444, 55555, 666666, 7777777, 88888888 };
+
+  locked_filebuf buf(path);
+  std::ostream os(&buf);
+  if (atomic) os << pretty_print::atomic_records;
+
+  const double t = time_ms([&] {
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i != threads; ++i)
+      workers.emplace_back([&] { for (std::size_t k = 0; k != n / threads; ++k) os << record; });
+    for (auto & w : workers) w.join();
+  });
+
+  std::cout << "  " << (atomic ? "atomic records:   " : "per-element writes:") << " " << t << " ms, "
+            << double(buf.locks) / double(n / threads * threads) << " lock acquisitions per record ("
+            << threads << " threads)" << std::endl;
+}
+
+
+/* Several threads record into a flight_recorder while another one keeps dumping it.
+   Every record repeats one value, so a dumped line whose text mixes two records
+   shows up as a torn record. Once the writers are done, the final dump has to hold
+   the newest record of every slot: for each writer, a run of its latest records
+   without gaps, apart from records which record() reported as dropped. */
+
+bool parse_record(const std::string & line, unsigned long & value)
+{
+  unsigned long long timestamp;
+  unsigned long v[4];
+  int end = -1;
+  return std::sscanf(line.c_str(), "%llu [%lu, %lu, %lu, %lu]%n", &timestamp, &v[0], &v[1], &v[2], &v[3], &end) == 5
+      && std::size_t(end) == line.size() && v[0] == v[1] && v[1] == v[2] && v[2] == v[3] && (value = v[0], true);
+}
+
+bool check_flight_recorder(std::size_t records)
+{
+  const unsigned writers = 4;
+  const std::size_t slots = 256;
+  const unsigned long stride = 10000000;
+
+  pretty_print::flight_recorder recorder(slots, 64);
+  std::vector<std::vector<unsigned long>> dropped(writers);
+  std::atomic<unsigned> running(writers);
+
+  unsigned long dumps = 0, lines = 0, torn = 0;
+  std::thread dumper([&] {
+    do
+    {
+      std::ostringstream os;
+      recorder.dump(os);
+      std::istringstream is(os.str());
+      unsigned long value;
+      for (std::string line; std::getline(is, line); ++lines)
+        if (!parse_record(line, value)) ++torn;
+      ++dumps;
+    }
+    while (running != 0);
+  });
+
+  std::vector<std::thread> workers;
+  for (unsigned w = 0; w != writers; ++w)
+    workers.emplace_back([&, w] {
+      for (unsigned long i = 0; i != records; ++i)
+        if (!recorder.record(std::vector<unsigned long>(4, w * stride + i)))
+          dropped[w].push_back(i);
+      --running;
+    });
+  for (auto & w : workers) w.join();
+  dumper.join();
+
+  std::ostringstream os;
+  recorder.dump(os);
+  std::istringstream is(os.str());
+  std::vector<std::vector<unsigned long>> present(writers);
+  unsigned long final_lines = 0;
+  for (std::string line; std::getline(is, line); ++final_lines)
+  {
+    unsigned long value;
+    if (parse_record(line, value) && value / stride < writers && value % stride < records)
+      present[value / stride].push_back(value % stride);
+    else
+      ++torn;
+  }
+
+  // A writer's records take increasing slots, so those left in the ring must be
+  // its latest ones: everything from its oldest record in the ring onwards.
+
+  unsigned long missing = 0;
+  for (unsigned w = 0; w != writers; ++w)
+  {
+    std::sort(present[w].begin(), present[w].end());
+    if (present[w].empty()) continue;
+    for (unsigned long i = present[w].front(), k = 0; i != records; ++i)
+    {
+      if (k != present[w].size() && present[w][k] == i) ++k;
+      else if (!std::binary_search(dropped[w].begin(), dropped[w].end(), i)) ++missing;
+    }
+  }
+  if (final_lines + recorder.dropped() < slots) missing += slots - final_lines - recorder.dropped();
+
+  std::cout << "Flight recorder (" << writers << " writers, " << records << " records each):" << std::endl
+            << "  " << dumps << " concurrent dumps with " << lines << " records, "
+            << recorder.dropped() << " records dropped, " << final_lines << " in the final dump" << std::endl;
+  if (torn != 0)
+    std::cout << "  FAILED: " << torn << " dumped records were not intact" << std::endl;
+  if (missing != 0)
+    std::cout << "  FAILED: " << missing << " of the newest records were missing from the final dump" << std::endl;
+  return torn == 0 && missing == 0;
+}
+
+
+/* A preallocated in-memory sink which just wraps around when full. */
+
+class scratch_sink : public std::streambuf
+{
+public:
+  scratch_sink() { setp(buffer, buffer + sizeof buffer); }
+
+protected:
+  int_type overflow(int_type c)
+  {
+    setp(buffer, buffer + sizeof buffer);
+    return traits_type::not_eof(c);
+  }
+
+private:
+  char buffer[1 << 16];
+};
+
+struct AngleDelims { static const pretty_print::delimiters_values<char> values; };
+const pretty_print::delimiters_values<char> AngleDelims::values = { "<", "; ", ">" };
+
+
+/* Prints x with every available engine and compares the results byte for byte with "stream << x". */
+
+typedef pretty_print::dataset::rng_type rng_type;
+
+/* A container with an operator<< of its own; every engine must leave its printing to that. */
+
+struct tagged_list : std::vector<int> { };
+
+std::ostream & operator<<(std::ostream & os, const tagged_list & l)
+{
+  return os << "list(" << l.size() << ")";
+}
+
+namespace pretty_print { namespace dataset {
+  template <>
+  struct generator<tagged_list>
+  {
+    static tagged_list make(rng_type & rng, const shape & s, std::size_t depth)
+    {
+      tagged_list l;
+      static_cast<std::vector<int> &>(l) = generator<std::vector<int>>::make(rng, s, depth);
+      return l;
+    }
+  };
+} }
+
+#if PRETTY_PRINT_HAS_COROUTINES
+/* An in-process pipe which holds at most capacity characters, for async_write.
+   The reading side drains it and resumes the writer waiting for room. */
+
+template <typename TChar>
+class pipe_sink
+{
+public:
+  typedef TChar char_type;
+
+  explicit pipe_sink(std::size_t capacity) : capacity(capacity) { }
+
+  std::size_t write_some(const TChar * p, std::size_t n)
+  {
+    n = std::min(n, capacity - buffer.size());
+    buffer.append(p, n);
+    return n;
+  }
+
+  struct awaiter
+  {
+    pipe_sink & pipe;
+    bool await_ready() const noexcept { return pipe.buffer.size() < pipe.capacity; }
+    void await_suspend(std::coroutine_handle<> h) noexcept { pipe.writer = h; }
+    void await_resume() noexcept { }
+  };
+
+  awaiter writable() { return awaiter { *this }; }
+
+  /* Moves the buffered text to out and resumes the writer, if it waits. */
+  void drain(std::basic_string<TChar> & out)
+  {
+    out += buffer;
+    buffer.clear();
+    const std::coroutine_handle<> h = writer;
+    writer = nullptr;
+    if (h) h.resume();
+  }
+
+private:
+  const std::size_t capacity;
+  std::basic_string<TChar> buffer;
+  std::coroutine_handle<> writer;
+};
+
+/* A coroutine which runs as soon as it is called, up to its first suspension. */
+
+struct eager_task
+{
+  struct promise_type
+  {
+    eager_task get_return_object() { return eager_task(); }
+    std::suspend_never initial_suspend() noexcept { return { }; }
+    std::suspend_never final_suspend() noexcept { return { }; }
+    void return_void() { }
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+template <typename TChar, typename T>
+eager_task write_to_pipe(pipe_sink<TChar> & pipe, const T & x, bool & done)
+{
+#if PRETTY_PRINT_HAS_PMR
+  // The printer's stack and the write_task frame come from the arena.
+  char storage[4096];
+  std::pmr::monotonic_buffer_resource arena(storage, sizeof storage);
+  co_await pretty_print::async_write(pipe, x, &arena);
+#else
+  co_await pretty_print::async_write(pipe, x);
+#endif
+  done = true;
+}
+
+/* Prints x through a pipe of the given capacity, draining it whenever the writer waits. */
+
+template <typename TChar, typename T>
+std::basic_string<TChar> print_through_pipe(const T & x, std::size_t capacity)
+{
+  pipe_sink<TChar> pipe(capacity);
+  std::basic_string<TChar> text;
+  bool done = false;
+  write_to_pipe(pipe, x, done);
+  while (!done) pipe.drain(text);
+  pipe.drain(text);
+  return text;
+}
+#endif
+
+template <typename TChar, typename T>
+bool engines_agree(const T & x, rng_type & rng)
+{
+  typedef std::basic_string<TChar> string_type;
+  std::basic_ostringstream<TChar> reference;
+  reference << x;
+  const string_type expected = reference.str();
+
+  std::basic_ostringstream<TChar> atomic;
+  atomic << pretty_print::atomic_records << x;
+
+  pretty_print::incremental_printer<TChar> printer(x);
+  string_type incremental;
+  TChar chunk[16];
+  while (!printer.done()) incremental.append(chunk, printer.pump(chunk, 1 + rng() % 16));
+
+  const string_type converted = pretty_print::to_string<TChar>(x);
+#if PRETTY_PRINT_HAS_PMR
+  const std::pmr::basic_string<TChar> converted_pmr = pretty_print::to_string<TChar>(x, std::pmr::new_delete_resource());
+#else
+  const string_type & converted_pmr = converted;
+#endif
+
+  // x is printed twice per generation, so that both a miss and a hit are checked.
+  static pretty_print::format_cache<TChar> cache(1 << 20);
+  static std::uint64_t generation = 0;
+  ++generation;
+  std::basic_ostringstream<TChar> cached;
+  cached << cache(x, generation) << cache(x, generation);
+
+  bool ok = atomic.str() == expected && incremental == expected
+         && converted == expected
+         && string_type(converted_pmr.begin(), converted_pmr.end()) == expected
+         && cached.str() == expected + expected;
+
+#if PRETTY_PRINT_HAS_COROUTINES
+  ok = ok && print_through_pipe<TChar>(x, 1 + rng() % 64) == expected;
+#endif
+
+  if (!ok)
+    std::cout << "  Mismatch for " << std::string(expected.begin(), expected.end()) << std::endl;
+  return ok;
+}
+
+/* Checks iterations values from make(rng); returns false on any mismatch. */
+
+template <typename TChar, typename F>
+bool verify_shape(const char * name, std::size_t iterations, rng_type & rng, F make)
+{
+  std::size_t failures = 0;
+  for (std::size_t i = 0; i != iterations; ++i)
+    if (!engines_agree<TChar>(make(), rng)) ++failures;
+  std::cout << "  " << name << ": " << iterations - failures << "/" << iterations << " identical" << std::endl;
+  return failures == 0;
+}
+
+template <typename TChar, typename T>
+bool verify_shape(const char * name, std::size_t iterations, rng_type & rng)
+{
+  return verify_shape<TChar>(name, iterations, rng, [&] { return pretty_print::dataset::make<T>(rng); });
+}
+
+bool verify_engines(std::size_t iterations, unsigned seed)
+{
+  rng_type rng(seed);
+  bool ok = true;
+
+  std::cout << "Engine agreement (seed " << seed << "):" << std::endl;
+  ok &= verify_shape<char, std::vector<std::map<int, std::set<std::string>>>>("vector<map<int, set<string>>>", iterations, rng);
+  ok &= verify_shape<char, std::map<std::string, std::pair<double, std::vector<char>>>>("map<string, pair<double, vector<char>>>", iterations, rng);
+  ok &= verify_shape<char, std::vector<std::tuple<int, std::valarray<double>, std::pair<char, std::string>>>>("vector<tuple<int, valarray<double>, pair<char, string>>>", iterations, rng);
+  ok &= verify_shape<char, std::map<int, std::vector<tagged_list>>>("map<int, vector<tagged_list>>", iterations, rng);
+  ok &= verify_shape<wchar_t, std::vector<std::pair<std::wstring, std::set<wchar_t>>>>("wchar_t: vector<pair<wstring, set<wchar_t>>>", iterations, rng);
+
+#if __cplusplus >= 201703L
+  ok &= verify_shape<char>("vector<pair<string_view, tuple<int, string_view>>>", iterations, rng, [&] {
+    // The views refer to strings which live until the next call.
+    static std::vector<std::string> strings;
+    strings = pretty_print::dataset::make<std::vector<std::string>>(rng);
+    std::vector<std::pair<std::string_view, std::tuple<int, std::string_view>>> v;
+    for (const std::string & str : strings)
+      v.emplace_back(str, std::make_tuple(int(str.size()), std::string_view(str).substr(str.size() / 2)));
+    return v;
+  });
+#endif
+
+  if (!ok)
+    std::cout << "  FAILED: the engines disagree" << std::endl;
+  return ok;
+}
+
+
+/* Hardware performance counters of the calling thread, via perf_event_open(2) on Linux.
+   Counters which cannot be opened (no permission, no PMU in a VM, ...) read as unavailable. */
+
+class perf_counters
+{
+public:
+  enum counter { cycles, instructions, branch_misses, l1d_misses, llc_misses, count };
+
+  perf_counters()
+  {
+    for (int i = 0; i != count; ++i) fds[i] = -1;
+
+#ifdef __linux__
+    const std::uint32_t types[count] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE };
+    const std::uint64_t configs[count] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+      PERF_COUNT_HW_CACHE_MISSES };
+
+    for (int i = 0; i != count; ++i)
+    {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof attr);
+      attr.size = sizeof attr;
+      attr.type = types[i];
+      attr.config = configs[i];
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+
+      fds[i] = int(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+      if (fds[i] < 0 && error.empty()) error = std::strerror(errno);
+    }
+#else
+    error = "not supported on this platform";
+#endif
+  }
+
+  ~perf_counters()
+  {
+#ifdef __linux__
+    for (int fd : fds) if (fd >= 0) ::close(fd);
+#endif
+  }
+
+  bool any() const
+  {
+    for (int fd : fds) if (fd >= 0) return true;
+    return false;
+  }
+
+  /* Why some counter could not be opened, if any. */
+  const std::string & why() const { return error; }
+
+  void start()
+  {
+#ifdef __linux__
+    for (int fd : fds) if (fd >= 0) { ::ioctl(fd, PERF_EVENT_IOC_RESET, 0); ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0); }
+#endif
+  }
+
+  void stop()
+  {
+#ifdef __linux__
+    for (int i = 0; i != count; ++i)
+    {
+      values[i] = -1;
+      if (fds[i] < 0) continue;
+      ::ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+      std::uint64_t v;
+      if (::read(fds[i], &v, sizeof v) == ssize_t(sizeof v)) values[i] = double(v);
+    }
+#endif
+  }
+
+  /* The value of counter c from the last start()/stop() pair, or a negative number if unavailable. */
+  double value(counter c) const { return values[c]; }
+
+private:
+  int fds[count];
+  double values[count] = { -1, -1, -1, -1, -1 };
+  std::string error;
+};
+
+template <typename T>
+void report_counters(const char * name, const T & x, std::size_t elements, perf_counters & counters)
+{
+  scratch_sink sink;
+  std::ostream os(&sink);
+
+  os << x;    // warm up
+  counters.start();
+  os << x;
+  counters.stop();
+
+  const double n = double(elements);
+  const auto per_element = [&](perf_counters::counter c) -> std::string {
+    return counters.value(c) < 0 ? "n/a" : std::to_string(counters.value(c) / n);
+  };
+
+  std::cout << "  " << name << ": IPC ";
+  if (counters.value(perf_counters::cycles) > 0 && counters.value(perf_counters::instructions) >= 0)
+    std::cout << counters.value(perf_counters::instructions) / counters.value(perf_counters::cycles);
+  else
+    std::cout << "n/a";
+  std::cout << ", per element: cycles " << per_element(perf_counters::cycles)
+            << ", instructions " << per_element(perf_counters::instructions)
+            << ", branch misses " << per_element(perf_counters::branch_misses)
+            << ", L1D misses " << per_element(perf_counters::l1d_misses)
+            << ", LLC misses " << per_element(perf_counters::llc_misses) << std::endl;
+}
+
+/* One shape per print_container_helper<T>::printer specialization (generic range, pair, tuple),
+   plus node-based containers to separate pointer chasing from formatting. */
+
+void bench_counters(std::size_t n)
+{
+  perf_counters counters;
+
+  std::cout << "Hardware counters:" << std::endl;
+  if (!counters.any())
+  {
+    std::cout << "  unavailable (" << counters.why() << ")" << std::endl;
+    return;
+  }
+
+  std::vector<int> v(n);
+  for (std::size_t i = 0; i != n; ++i) v[i] = int(i * 2654435761u % 1000000);
+  const std::list<int> l(v.begin(), v.end());
+  std::map<int, int> m;
+  for (std::size_t i = 0; i != n; ++i) m[v[i]] = int(i);
+
+  report_counters("vector<int> (range)", v, n, counters);
+  report_counters("list<int> (range, node-based)", l, n, counters);
+  report_counters("map<int, int> (range + pair, node-based)", m, m.size(), counters);
+  std::vector<std::pair<int, int>> vp;
+  std::vector<std::tuple<int, int, int>> vt;
+  for (std::size_t i = 0; i != n; ++i)
+  {
+    vp.emplace_back(v[i], int(i));
+    vt.emplace_back(v[i], int(i), -v[i]);
+  }
+
+  report_counters("vector<pair<int, int>> (range + pair)", vp, n, counters);
+  report_counters("vector<tuple<int, int, int>> (range + tuple)", vt, n, counters);
+}
+
+
+/* A histogram of nanosecond latencies in the style of HdrHistogram: values
+   below 128 are exact, larger ones fall into 64 linear sub-buckets per power
+   of two, which bounds the relative error of any reported value by 1/64. */
+
+class latency_histogram
+{
+public:
+  latency_histogram() : counts(sub_count + 58 * half_count), total(0), largest(0) { }
+
+  void record(std::uint64_t v)
+  {
+    ++counts[index_of(v)];
+    ++total;
+    if (v > largest) largest = v;
+  }
+
+  std::uint64_t count() const { return total; }
+  std::uint64_t max() const { return largest; }
+
+  /* The highest value equivalent to the one at quantile q in [0, 1]. */
+  std::uint64_t quantile(double q) const
+  {
+    const std::uint64_t rank = std::uint64_t(q * double(total) + 0.5);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i != counts.size(); ++i)
+    {
+      seen += counts[i];
+      if (seen >= rank && seen != 0) return std::min(highest_equivalent(i), largest);
+    }
+    return largest;
+  }
+
+private:
+  static const unsigned sub_count = 128;
+  static const unsigned half_count = sub_count / 2;
+
+  static std::size_t index_of(std::uint64_t v)
+  {
+    if (v < sub_count) return std::size_t(v);
+    unsigned shift = 1;
+    while ((v >> shift) >= sub_count) ++shift;
+    return sub_count + (shift - 1) * half_count + std::size_t((v >> shift) - half_count);
+  }
+
+  static std::uint64_t highest_equivalent(std::size_t i)
+  {
+    if (i < sub_count) return i;
+    const unsigned shift = unsigned((i - sub_count) / half_count) + 1;
+    const std::uint64_t sub = (i - sub_count) % half_count + half_count;
+    return ((sub + 1) << shift) - 1;
+  }
+
+  std::vector<std::uint64_t> counts;
+  std::uint64_t total;
+  std::uint64_t largest;
+};
+
+
+/* Per-call latency of printing small values, where fixed costs (helper construction,
+   sentries, delimiter lookup) rather than the elements dominate. Each call is timed
+   on its own; the cost of reading the clock is reported alongside and included. */
+
+template <typename F>
+void report_latency(const char * name, std::size_t calls, F f)
+{
+  latency_histogram h;
+  for (std::size_t i = 0; i != calls / 100; ++i) f();    // warm up
+
+  for (std::size_t i = 0; i != calls; ++i)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    h.record(std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+  }
+
+  std::cout << "  " << name << ": p50 " << h.quantile(0.5) << ", p99 " << h.quantile(0.99)
+            << ", p999 " << h.quantile(0.999) << ", max " << h.max() << std::endl;
+}
+
+void bench_latency(std::size_t calls)
+{
+  scratch_sink sink;
+  std::ostream os(&sink);
+
+  const std::pair<int, int> p(17, -4);
+  const std::tuple<int, std::string, double> t(3, "three", 3.0);
+  const std::vector<int> v { 1, 2, 3, 4, 5 };
+
+  std::cout << "Per-call latency in ns over " << calls << " calls:" << std::endl;
+  report_latency("clock only", calls, [] { });
+  report_latency("int", calls, [&] { os << 12345; });
+  report_latency("pair<int, int>", calls, [&] { os << p; });
+  report_latency("tuple<int, string, double>", calls, [&] { os << t; });
+  report_latency("vector<int>(5)", calls, [&] { os << v; });
+  report_latency("custom_delims, vector<int>(5)", calls, [&] { os << pretty_print::custom_delims<AngleDelims>(v); });
+
+  std::ostream records(&sink);
+  records << pretty_print::atomic_records;
+  report_latency("atomic_records, vector<int>(5)", calls, [&] { records << v; });
+}
+
+
+/* Throughput of each printing engine on the datasets of prettyprint_dataset.hpp. */
+
+/* Times the engines on x. The two stream engines are timed on their second print,
+   when the scratch buffer of atomic_records, which keeps its capacity from print
+   to print, has already grown. */
+
+struct engine_timer
+{
+  template <typename T>
+  void operator()(const T & x) const
+  {
+    scratch_sink sink;
+    std::ostream os(&sink);
+    std::ostream records(&sink);
+    records << pretty_print::atomic_records;
+
+    os << x;
+    const double stream_ms = time_ms([&] { os << x; });
+    records << x;
+    const double atomic_ms = time_ms([&] { records << x; });
+    const double string_ms = time_ms([&] { pretty_print::to_string(x); });
+    const double incremental_ms = time_ms([&] {
+      pretty_print::incremental_printer<char> printer(x);
+      char chunk[4096];
+      while (!printer.done()) os.write(chunk, printer.pump(chunk, sizeof chunk));
+    });
+
+    std::cout << "stream " << stream_ms << " ms, atomic_records " << atomic_ms << " ms, to_string "
+              << string_ms << " ms, incremental " << incremental_ms << " ms" << std::endl;
+  }
+};
+
+void bench_datasets(std::size_t n, unsigned seed)
+{
+  std::cout << "Engines on datasets of " << n << " elements (seed " << seed << "):" << std::endl;
+  for (const auto & e : pretty_print::dataset::catalogue)
+  {
+    std::cout << "  " << e.name << ": " << std::flush;
+    engine_timer f;
+    pretty_print::dataset::visit(e.name, e.name == std::string("nested-skewed") ? n / 100 : n, seed, f);
+  }
+}
+
+
+
+/* A table which never changes, printed by every thread over and over: formatted
+   each time, and through a format_cache. */
+
+void bench_cache(unsigned seed)
+{
+  const unsigned threads = std::max(4u, std::thread::hardware_concurrency());
+  const std::size_t prints = 200;
+
+  pretty_print::dataset::shape s;
+  s.sizes.assign(1, pretty_print::dataset::distribution::fixed(10000));
+  const auto table = pretty_print::dataset::make<std::map<int, std::string>>(seed, s);
+
+  pretty_print::format_cache<> cache(1 << 20);
+
+  auto run = [&](bool cached) {
+    return time_ms([&] {
+      std::vector<std::thread> workers;
+      for (unsigned i = 0; i != threads; ++i)
+        workers.emplace_back([&] {
+          scratch_sink sink;
+          std::ostream os(&sink);
+          for (std::size_t k = 0; k != prints; ++k)
+            if (cached) os << cache(table, 1); else os << table;
+        });
+      for (auto & w : workers) w.join();
+    });
+  };
+
+  const double formatted_ms = run(false);
+  const double cached_ms = run(true);
+
+  std::cout << "Printing a 10000 element map " << prints << " times on each of " << threads << " threads:" << std::endl
+            << "  formatted " << formatted_ms << " ms, cached " << cached_ms << " ms ("
+            << cache.misses() << " misses, " << cache.bytes() << " bytes cached)" << std::endl;
+}
+
+int main(int argc, char * argv[])
+{
+  const std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+  const char * const path = argc > 2 ? argv[2] : "ppbench.out";
+
+  std::vector<std::pair<int, std::string>> data;
+  data.reserve(n);
+  for (std::size_t i = 0; i != n; ++i)
+    data.emplace_back(int(i), "value-" + std::to_string(i));
+
+  const unsigned seed = argc > 3 ? unsigned(std::strtoul(argv[3], nullptr, 10)) : 5489u;
+
+  const bool engines_ok = verify_engines(1000, seed);
+
+  bench_datasets(n, seed);
+
+  bench_counters(n);
+
+  bench_latency(n);
+
+  bench_cache(seed);
+
+  bench_file_sinks(data, path);
+
+  std::cout << "Shared stream contention:" << std::endl;
+  bench_contention(n, path, false);
+  bench_contention(n, path, true);
+
+  const bool recorder_ok = check_flight_recorder(std::max<std::size_t>(n / 10, 1000));
+
+  std::remove(path);
+
+  return engines_ok && recorder_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
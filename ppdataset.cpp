@@ -0,0 +1,38 @@
+/* Writes a named benchmark dataset from prettyprint_dataset.hpp to standard output,
+   e.g. "ppdataset nested-skewed 1000 42". Without arguments, lists the datasets.
+   The output is the same for the same arguments on every platform.
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "prettyprint.hpp"
+#include "prettyprint_dataset.hpp"
+
+struct print_value
+{
+  template <typename T> void operator()(const T & x) const { std::cout << x << std::endl; }
+};
+
+int main(int argc, char * argv[])
+{
+  namespace dataset = pretty_print::dataset;
+
+  if (argc < 2)
+  {
+    std::cout << "Usage: ppdataset name [count] [seed]" << std::endl;
+    for (const auto & e : dataset::catalogue) std::cout << "  " << e.name << ": " << e.description << std::endl;
+    return 0;
+  }
+
+  const std::size_t count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000;
+  const auto seed = std::uint32_t(argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 5489u);
+
+  print_value f;
+  if (!dataset::visit(argv[1], count, seed, f))
+  {
+    std::cerr << "Unknown dataset: " << argv[1] << std::endl;
+    return 1;
+  }
+}
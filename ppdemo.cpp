@@ -30,6 +30,11 @@ struct MyDelims { static const pretty_print::delimiters_values<char> values; };
 const pretty_print::delimiters_values<char> MyDelims::values = { "<", "; ", ">" };
 
 
+#if __cplusplus >= 201703L
+/* A constant table, which can be formatted at compile time. */
+static constexpr std::array<std::pair<const char *, int>, 3> Limits = { { { "connections", 512 }, { "threads", 16 }, { "retries", 3 } } };
+#endif
+
 /* Demo: run with a couple of command-line arguments. */
 
 int main(int argc, char * argv[])
@@ -118,5 +123,32 @@ int main(int argc, char * argv[])
             << "n-tuple: " << a3 << std::endl
             << "n-tuple: " << a4 << std::endl
             << "Hashmap bucket: " << bucket_print(um, 0) << std::endl
+            << "OMap keys: " << pretty_print::keys(om) << std::endl
+            << "OMap values: " << pretty_print::values(om) << std::endl
+            << "Pair firsts: " << pretty_print::project(vp, &std::pair<int, std::string>::first) << std::endl
+            << "Zipped columns: " << pretty_print::zip(vd, v, arr) << std::endl
   ;
+
+  /* Demo: filtered views print only the matching elements, without copying them. */
+  auto odd = pretty_print::filter(arr, [](int n) { return n % 2 != 0; }, 1);
+  std::cout << "Filtered: " << odd;
+  std::cout << " (" << odd.skipped() << " skipped)" << std::endl
+            << "Changed: " << pretty_print::where_changed(v, std::vector<std::string>(argc - 1, "b")) << std::endl;
+
+  /* Demo: single-pass sources are streamed straight through. */
+  std::istringstream numbers("3 1 4 1 5");
+  std::cout << "Streamed: " << pretty_print::range<int>(numbers) << std::endl;
+
+  /* Demo: resumable printing, a few characters at a time (as for a non-blocking sink). */
+  pretty_print::incremental_printer<> inc(vp);
+  char chunk[8];
+  std::cout << "Incremental: ";
+  while (!inc.done())
+    std::cout.write(chunk, inc.pump(chunk, sizeof chunk));
+  std::cout << std::endl;
+
+#if __cplusplus >= 201703L
+  /* Demo: text formatted at compile time. */
+  std::cout << "Static table: " << pretty_print::static_string<Limits>() << std::endl;
+#endif
 }
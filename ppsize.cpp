@@ -0,0 +1,59 @@
+/* A binary-size benchmark: prints 160 distinct container types, the way a large
+   program does. Compare "size" of the binary built with different switches:
+     g++ -O2 -std=c++0x ppsize.cpp -o ppsize
+     g++ -O2 -std=c++0x -DPRETTY_PRINT_ATOMIC_RECORDS=1 ppsize.cpp -o ppsize-records
+   Run with an iteration count to time the printing, e.g. "ppsize 10000".
+*/
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <list>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include "prettyprint.hpp"
+
+
+/* Prints four containers whose types depend on N, then recurses to N - 1. */
+
+template <std::size_t N>
+void print_family(std::ostream & os)
+{
+  std::array<int, N> a;
+  for (std::size_t i = 0; i != N; ++i) a[i] = int(i);
+
+  os << std::vector<std::array<int, N>>(2, a)
+     << std::list<std::array<int, N>>(2, a)
+     << std::deque<std::array<int, N>>(2, a)
+     << std::map<int, std::array<int, N>>{ { 1, a }, { 2, a } };
+
+  print_family<N - 1>(os);
+}
+
+template <>
+void print_family<0>(std::ostream &)
+{
+}
+
+
+int main(int argc, char * argv[])
+{
+  const unsigned long iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1;
+
+  std::ostringstream os;
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned long i = 0; i != iterations; ++i)
+  {
+    os.str(std::string());
+    print_family<40>(os);
+  }
+  const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << os.str().size() << " characters per iteration, " << ms / double(iterations) * 1000.0
+            << " us per iteration" << std::endl;
+}
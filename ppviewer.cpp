@@ -0,0 +1,158 @@
+/* A viewer for snapshots published through pretty_print::shm_channel.
+   Run as "ppviewer /channel-name [poll interval in ms]" while the producer is running;
+   every record is printed on a line of its own.
+
+   "ppviewer --produce /channel-name [records] [interval in ms]" is a producer to
+   try it with: it publishes a changing map once per interval. "ppviewer --check"
+   runs a small channel past overrun in one process and exits with a nonzero
+   status if the reader's view of it is wrong.
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "prettyprint.hpp"
+#include "prettyprint_sinks.hpp"
+
+
+int view(const char * name, std::chrono::milliseconds interval)
+{
+  pretty_print::shm_channel_reader reader(name);
+  if (!reader.is_open())
+  {
+    std::cerr << "Cannot open channel " << name << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::string record;
+  std::uint64_t lost = 0;
+
+  for ( ; ; )
+  {
+    bool truncated = false;
+    while (reader.next(record, &truncated))
+      std::cout << record << (truncated ? "..." : "") << '\n';
+
+    if (reader.lost() != lost)
+    {
+      std::cout << "(" << reader.lost() - lost << " records lost)" << '\n';
+      lost = reader.lost();
+    }
+
+    std::cout.flush();
+    std::this_thread::sleep_for(interval);
+  }
+}
+
+int produce(const char * name, unsigned long records, std::chrono::milliseconds interval)
+{
+  pretty_print::shm_channel channel(name, 1 << 16);
+  if (!channel.is_open())
+  {
+    std::cerr << "Cannot create channel " << name << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::map<std::string, unsigned long> counters;
+  for (unsigned long i = 0; i != records; ++i)
+  {
+    ++counters[i % 3 == 0 ? "requests" : i % 3 == 1 ? "hits" : "misses"];
+    counters["snapshot"] = i;
+    channel.publish(counters);
+    std::this_thread::sleep_for(interval);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+
+/* Reports a failed expectation of the check. */
+
+bool expect(bool ok, const char * what)
+{
+  if (!ok) std::cout << "  FAILED: " << what << std::endl;
+  return ok;
+}
+
+int check()
+{
+  const std::string name = "/ppviewer-check-" + std::to_string(::getpid());
+  const std::size_t capacity = 256;
+
+  pretty_print::shm_channel channel(name.c_str(), capacity);
+  pretty_print::shm_channel_reader reader(name.c_str());
+  if (!channel.is_open() || !reader.is_open())
+  {
+    std::cerr << "Cannot create channel " << name << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bool ok = true;
+  std::string record;
+  bool truncated = false;
+
+  // A reader which keeps up sees every record.
+
+  channel.publish(std::vector<int> { 1, 2 });
+  ok &= expect(reader.next(record, &truncated) && record == "[1, 2]" && !truncated, "first record");
+  ok &= expect(!reader.next(record), "no record beyond the head");
+
+  // Twenty records of 20 bytes or more do not fit into 256 bytes: the reader
+  // skips to the newest one and accounts for the others as lost.
+
+  const unsigned long published = 20;
+  for (unsigned long i = 0; i != published; ++i)
+    channel.publish(std::vector<unsigned long> { 1000 + i });
+
+  unsigned long read = 0;
+  std::string last;
+  while (reader.next(record, &truncated))
+  {
+    ++read;
+    last = record;
+  }
+
+  ok &= expect(reader.lost() != 0, "records lost after overrun");
+  ok &= expect(read + reader.lost() == published, "read and lost records add up");
+  ok &= expect(last == "[1019]", "newest record read after overrun");
+
+  // A record longer than half the ring is cut there and flagged.
+
+  channel.publish(std::vector<int>(100, 7));
+  ok &= expect(reader.next(record, &truncated), "long record");
+  ok &= expect(truncated && record.size() == capacity / 2, "long record truncated to half the ring");
+
+  std::cout << "Channel check: " << read << " of " << published << " records read, "
+            << reader.lost() << " lost" << (ok ? "" : "; FAILED") << std::endl;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+
+int main(int argc, char * argv[])
+{
+  const std::string mode = argc > 1 ? argv[1] : "";
+
+  if (mode == "--check")
+    return check();
+
+  if (mode == "--produce" && argc > 2)
+    return produce(argv[2], argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1000,
+                   std::chrono::milliseconds(argc > 4 ? std::atoi(argv[4]) : 100));
+
+  if (argc < 2 || mode.compare(0, 2, "--") == 0)
+  {
+    std::cerr << "Usage: " << argv[0] << " /channel-name [poll interval in ms]" << std::endl
+              << "       " << argv[0] << " --produce /channel-name [records] [interval in ms]" << std::endl
+              << "       " << argv[0] << " --check" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return view(argv[1], std::chrono::milliseconds(argc > 2 ? std::atoi(argv[2]) : 100));
+}
@@ -7,359 +7,768 @@
 //
 // Usage:
 // Include this header, and operator<< will "just work".
+// This is prettyprint_core.hpp with all family headers, plus the wrappers and
+// printing engines below; include only the core to keep compile times down.
 
 #ifndef H_PRETTY_PRINT
 #define H_PRETTY_PRINT
 
+#include "prettyprint_core.hpp"
+#include "prettyprint_set.hpp"
+#include "prettyprint_tuple.hpp"
+#include "prettyprint_unordered_set.hpp"
+#include "prettyprint_valarray.hpp"
+
 #include <cstddef>
+#include <istream>
 #include <iterator>
 #include <memory>
-#include <ostream>
-#include <set>
+#include <new>
+#include <string>
 #include <tuple>
 #include <type_traits>
-#include <unordered_set>
 #include <utility>
-#include <valarray>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#  if __has_include(<coroutine>)
+#    include <coroutine>
+#    include <exception>
+#    define PRETTY_PRINT_HAS_COROUTINES 1
+#  endif
+#endif
+
+#ifndef PRETTY_PRINT_HAS_COROUTINES
+#  define PRETTY_PRINT_HAS_COROUTINES 0
+#endif
+
+#if __cplusplus >= 201703L
+#  include <string_view>
+#endif
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#  if __has_include(<memory_resource>)
+#    include <memory_resource>
+#  endif
+#endif
+
+#if defined(__cpp_lib_memory_resource)
+#  define PRETTY_PRINT_HAS_PMR 1
+#else
+#  define PRETTY_PRINT_HAS_PMR 0
+#endif
 
 namespace pretty_print
 {
     namespace detail
     {
-        // SFINAE type trait to detect whether T::const_iterator exists.
+        // Compile-time index list, for expanding over tuples of iterators.
+
+        template <std::size_t ...I> struct index_sequence { };
+
+        template <std::size_t N, std::size_t ...I>
+        struct make_index_sequence : make_index_sequence<N - 1, N - 1, I...> { };
 
-        struct sfinae_base
+        template <std::size_t ...I>
+        struct make_index_sequence<0, I...> { using type = index_sequence<I...>; };
+
+        struct swallow
         {
-            using yes = char;
-            using no  = yes[2];
+            template <typename ...Args> swallow(Args &&...) { }
         };
 
-        template <typename T>
-        struct has_const_iterator : private sfinae_base
+        // Temporary storage. With std::pmr available, callers may pass the memory
+        // resource to allocate from; otherwise the global heap is used.
+
+#if PRETTY_PRINT_HAS_PMR
+        using resource_type = std::pmr::memory_resource *;
+        template <typename T> using temp_allocator = std::pmr::polymorphic_allocator<T>;
+
+        inline resource_type default_resource() { return std::pmr::get_default_resource(); }
+
+        template <typename T, typename ...Args>
+        T * create(resource_type r, Args && ...args)
         {
-        private:
-            template <typename C> static yes & test(typename C::const_iterator*);
-            template <typename C> static no  & test(...);
-        public:
-            static const bool value = sizeof(test<T>(nullptr)) == sizeof(yes);
-            using type =  T;
-        };
+            void * p = r->allocate(sizeof(T), alignof(T));
+            try { return ::new (p) T(std::forward<Args>(args)...); }
+            catch (...) { r->deallocate(p, sizeof(T), alignof(T)); throw; }
+        }
 
         template <typename T>
-        struct has_begin_end : private sfinae_base
+        void destroy(resource_type r, T * p)
         {
-        private:
-            template <typename C>
-            static yes & f(typename std::enable_if<
-                std::is_same<decltype(static_cast<typename C::const_iterator(C::*)() const>(&C::begin)),
-                             typename C::const_iterator(C::*)() const>::value>::type *);
+            p->~T();
+            r->deallocate(p, sizeof(T), alignof(T));
+        }
+#else
+        using resource_type = std::nullptr_t;
+        template <typename T> using temp_allocator = std::allocator<T>;
 
-            template <typename C> static no & f(...);
+        inline resource_type default_resource() { return nullptr; }
 
-            template <typename C>
-            static yes & g(typename std::enable_if<
-                std::is_same<decltype(static_cast<typename C::const_iterator(C::*)() const>(&C::end)),
-                             typename C::const_iterator(C::*)() const>::value, void>::type*);
+        template <typename T, typename ...Args>
+        T * create(resource_type, Args && ...args)
+        {
+            return new T(std::forward<Args>(args)...);
+        }
 
-            template <typename C> static no & g(...);
+        template <typename T>
+        void destroy(resource_type, T * p)
+        {
+            delete p;
+        }
+#endif
 
-        public:
-            static bool const beg_value = sizeof(f<T>(nullptr)) == sizeof(yes);
-            static bool const end_value = sizeof(g<T>(nullptr)) == sizeof(yes);
-        };
+        template <typename T>
+        temp_allocator<T> make_temp_allocator(resource_type r)
+        {
+#if PRETTY_PRINT_HAS_PMR
+            return temp_allocator<T>(r);
+#else
+            return (void)r, temp_allocator<T>();
+#endif
+        }
 
     }  // namespace detail
 
 
-    // Holds the delimiter values for a specific character type
+    template <typename TIter, typename TSentinel>
+    struct iterator_range_wrapper;
 
-    template <typename TChar>
-    struct delimiters_values
+    template <typename TIter, typename TSentinel>
+    struct is_container<iterator_range_wrapper<TIter, TSentinel>> : std::true_type { };
+
+
+    namespace detail
     {
-        using char_type = TChar;
-        const char_type * prefix;
-        const char_type * delimiter;
-        const char_type * postfix;
-    };
+        // How the incremental printer treats a type: as a leaf which is formatted
+        // in one go, as an iterable range, or as a pair/tuple.
 
+        template <typename T>
+        struct incremental_kind : std::integral_constant<int, is_container<T>::value ? 1 : 0> { };
 
-    // Defines the delimiter values for a specific container and character type
+        template <typename TChar, typename TCharTraits, typename TAllocator>
+        struct incremental_kind<std::basic_string<TChar, TCharTraits, TAllocator>> : std::integral_constant<int, 0> { };
 
-    template <typename T, typename TChar>
-    struct delimiters
-    {
-        using type = delimiters_values<TChar>;
-        static const type values; 
-    };
+        template <typename T1, typename T2>
+        struct incremental_kind<std::pair<T1, T2>> : std::integral_constant<int, 2> { };
+
+        template <typename ...Args>
+        struct incremental_kind<std::tuple<Args...>> : std::integral_constant<int, 2> { };
+
+#if __cplusplus >= 201703L
+        template <typename TChar, typename TCharTraits>
+        struct incremental_kind<std::basic_string_view<TChar, TCharTraits>> : std::integral_constant<int, 0> { };
+#endif
+
+        // Whether "stream << x" resolves to the library's printer rather than to an
+        // operator<< of the type's own. The probes are more specialized than the
+        // library's std::operator<<, but lose to a non-template overload or one for a
+        // more specific type, and are ambiguous with other generic ones. They exist for
+        // std::ostream and std::wostream; other streams are assumed to use the library.
+
+        namespace probe
+        {
+            struct library_printer { };
+
+            template <typename T> library_printer operator<<(std::basic_ostream<char> &, const T &);
+            template <typename T> library_printer operator<<(std::basic_ostream<wchar_t> &, const T &);
+
+            template <typename TStream, typename T>
+            auto test(int) -> decltype(std::declval<TStream &>() << std::declval<const T &>());
+
+            template <typename TStream, typename T>
+            void test(...);
+
+        }  // namespace probe
 
+        template <typename T, typename TChar, typename TCharTraits>
+        struct uses_library_printer : std::integral_constant<bool,
+            !(std::is_same<TChar, char>::value || std::is_same<TChar, wchar_t>::value) ||
+            !std::is_same<TCharTraits, std::char_traits<TChar>>::value ||
+            std::is_same<decltype(probe::test<std::basic_ostream<TChar, TCharTraits>, T>(0)), probe::library_printer>::value> { };
 
-    // Functor to print containers. You can use this directly if you want
-    // to specificy a non-default delimiters type. The printing logic can
-    // be customized by specializing the nested template.
+        // The incremental kind of an element printed to a stream of TChar.
 
-    template <typename T,
-              typename TChar = char,
-              typename TCharTraits = ::std::char_traits<TChar>,
-              typename TDelimiters = delimiters<T, TChar>>
-    struct print_container_helper
+        template <typename T, typename TChar, typename TCharTraits>
+        struct element_kind : std::integral_constant<int,
+            uses_library_printer<T, TChar, TCharTraits>::value ? incremental_kind<T>::value : 0> { };
+
+    }  // namespace detail
+
+
+    // A resumable printer which produces the same text as "stream << x", a bounded
+    // number of characters at a time. The position at every nesting level is kept
+    // in an explicit stack of frames, so output can be interleaved with other work,
+    // e.g. when writing to a non-blocking socket. The printed object must outlive the
+    // printer and must not be modified while printing is in progress. Elements are
+    // formatted with the stream returned by format(), using the default delimiters;
+    // an element whose type has an operator<< of its own, like std::string_view, is
+    // formatted in one go.
+    // Usage: pretty_print::incremental_printer<> p(x);
+    //        while (!p.done()) { n = p.pump(buf, sizeof buf); write(fd, buf, n); }
+
+    template <typename TChar = char, typename TCharTraits = ::std::char_traits<TChar>>
+    class incremental_printer
     {
-        using delimiters_type = TDelimiters;
+    public:
         using ostream_type = std::basic_ostream<TChar, TCharTraits>;
+        using string_type = std::basic_string<TChar, TCharTraits, detail::temp_allocator<TChar>>;
+
+        template <typename T>
+        explicit incremental_printer(const T & x)
+        : incremental_printer(x, detail::default_resource(), 0)
+        { }
+
+        // With std::pmr, all frames and the pending output are allocated from the given resource.
+
+        template <typename T>
+        incremental_printer(const T & x, detail::resource_type resource)
+        : incremental_printer(x, resource, 0)
+        { }
 
-        template <typename U>
-        struct printer
+        incremental_printer(const incremental_printer &) = delete;
+        incremental_printer & operator=(const incremental_printer &) = delete;
+
+        ~incremental_printer()
         {
-            static void print_body(const U & c, ostream_type & stream)
+            while (m_top) pop();
+        }
+
+        // Writes at most max_chars characters to buffer; returns the number written.
+
+        std::size_t pump(TChar * buffer, std::size_t max_chars)
+        {
+            std::size_t n = 0;
+
+            while (n < max_chars)
             {
-                using std::begin;
-                using std::end;
+                if (m_offset < m_pending.size())
+                {
+                    const std::size_t avail = m_pending.size() - m_offset;
+                    const std::size_t k = avail < max_chars - n ? avail : max_chars - n;
+                    TCharTraits::copy(buffer + n, m_pending.data() + m_offset, k);
+                    n += k;
+                    m_offset += k;
+                    continue;
+                }
+
+                m_pending.clear();
+                m_offset = 0;
+
+                if (!m_top) break;
+
+                if (!m_top->step(*this)) pop();
+            }
+
+            return n;
+        }
+
+        bool done() const
+        {
+            return !m_top && m_offset == m_pending.size();
+        }
+
+        ostream_type & format()
+        {
+            return m_leaf;
+        }
+
+    private:
+        template <typename T>
+        incremental_printer(const T & x, detail::resource_type resource, int)
+        : m_top(nullptr), m_resource(resource),
+          m_pending(detail::make_temp_allocator<TChar>(resource)), m_offset(0), m_buf(m_pending), m_leaf(&m_buf)
+        {
+            emit(x);
+        }
 
-                auto it = begin(c);
-                const auto the_end = end(c);
+        struct frame
+        {
+            frame() : parent(nullptr) { }
+            virtual ~frame() { }
+
+            // Produces the next token; returns false once the closing delimiter has been produced.
+            virtual bool step(incremental_printer & p) = 0;
+
+            virtual void destroy(detail::resource_type r) = 0;
+
+            frame * parent;
+        };
+
+        template <typename T, typename TStorage>
+        struct range_frame : frame
+        {
+            using delimiters_type = delimiters<T, TChar>;
 
-                if (it != the_end)
+            template <typename E>
+            explicit range_frame(E && c)
+            : m_c(std::forward<E>(c)), m_it(adl_begin(m_c)), m_end(adl_end(m_c)), m_state(0)
+            { }
+
+            void destroy(detail::resource_type r)
+            {
+                detail::destroy(r, this);
+            }
+
+            bool step(incremental_printer & p)
+            {
+                if (m_state == 0)
                 {
-                    for ( ; ; )
-                    {
-                        stream << *it;
+                    p.put(delimiters_type::values.prefix);
+                    m_state = 1;
+                    return true;
+                }
 
-                    if (++it == the_end) break;
+                // Advance only after the previous element is finished, since it may
+                // refer into the iterator itself.
+                if (m_state == 2) ++m_it;
 
-                    if (delimiters_type::values.delimiter != NULL)
-                        stream << delimiters_type::values.delimiter;
-                    }
+                if (m_it == m_end)
+                {
+                    p.put(delimiters_type::values.postfix);
+                    return false;
                 }
+
+                if (m_state == 2) p.put(delimiters_type::values.delimiter);
+                m_state = 2;
+
+                p.emit(*m_it);
+                return true;
             }
-        };
 
-        print_container_helper(const T & container)
-        : container_(container)
-        { }
+        private:
+            template <typename C> static auto adl_begin(C & c) -> decltype(std::begin(c)) { using std::begin; return begin(c); }
+            template <typename C> static auto adl_end(C & c) -> decltype(std::end(c)) { using std::end; return end(c); }
+
+            TStorage m_c;
+            decltype(adl_begin(std::declval<TStorage &>())) m_it;
+            const decltype(adl_end(std::declval<TStorage &>())) m_end;
+            int m_state;
+        };
 
-        inline void operator()(ostream_type & stream) const
+        template <typename T, typename TStorage>
+        struct tuple_frame : frame
         {
-            if (delimiters_type::values.prefix != NULL)
-                stream << delimiters_type::values.prefix;
+            using delimiters_type = delimiters<T, TChar>;
+            static const std::size_t size = std::tuple_size<T>::value;
 
-            printer<T>::print_body(container_, stream);
+            template <typename E>
+            explicit tuple_frame(E && t) : m_t(std::forward<E>(t)), m_i(0), m_started(false) { }
 
-            if (delimiters_type::values.postfix != NULL)
-                stream << delimiters_type::values.postfix;
-        }
+            void destroy(detail::resource_type r)
+            {
+                detail::destroy(r, this);
+            }
 
-    private:
-        const T & container_;
-    };
+            bool step(incremental_printer & p)
+            {
+                if (!m_started)
+                {
+                    p.put(delimiters_type::values.prefix);
+                    m_started = true;
+                    return true;
+                }
 
-    // Specialization for pairs
+                if (m_i == size)
+                {
+                    p.put(delimiters_type::values.postfix);
+                    return false;
+                }
 
-    template <typename T, typename TChar, typename TCharTraits, typename TDelimiters>
-    template <typename T1, typename T2>
-    struct print_container_helper<T, TChar, TCharTraits, TDelimiters>::printer<std::pair<T1, T2>>
-    {
-        using ostream_type = typename print_container_helper<T, TChar, TCharTraits, TDelimiters>::ostream_type;
+                if (m_i != 0) p.put(delimiters_type::values.delimiter);
+
+                emit_at(p, m_i++, typename detail::make_index_sequence<size>::type());
+                return true;
+            }
+
+        private:
+            template <std::size_t I>
+            static void emit_get(incremental_printer & p, const T & t)
+            {
+                p.emit(std::get<I>(t));
+            }
 
-        static void print_body(const std::pair<T1, T2> & c, ostream_type & stream)
+            template <std::size_t ...I>
+            void emit_at(incremental_printer & p, std::size_t i, detail::index_sequence<I...>)
+            {
+                static void (* const table[])(incremental_printer &, const T &) = { nullptr, &emit_get<I>... };
+                table[i + 1](p, m_t);
+            }
+
+            TStorage m_t;
+            std::size_t m_i;
+            bool m_started;
+        };
+
+        void put(const TChar * s)
         {
-            stream << c.first;
-            if (print_container_helper<T, TChar, TCharTraits, TDelimiters>::delimiters_type::values.delimiter != NULL)
-                stream << print_container_helper<T, TChar, TCharTraits, TDelimiters>::delimiters_type::values.delimiter;
-            stream << c.second;
+            if (s != NULL) m_pending += s;
         }
-    };
 
-    // Specialization for tuples
+        // Lvalue elements are referred to; prvalues (e.g. proxies) are kept in the frame.
 
-    template <typename T, typename TChar, typename TCharTraits, typename TDelimiters>
-    template <typename ...Args>
-    struct print_container_helper<T, TChar, TCharTraits, TDelimiters>::printer<std::tuple<Args...>>
-    {
-        using ostream_type = typename print_container_helper<T, TChar, TCharTraits, TDelimiters>::ostream_type;
-        using element_type = std::tuple<Args...>;
+        template <typename E>
+        void emit(E && e)
+        {
+            using value_type = typename std::remove_cv<typename std::remove_reference<E>::type>::type;
+            using storage_type = typename std::conditional<std::is_lvalue_reference<E>::value &&
+                                                           !detail::needs_view_copy<value_type>::value,
+                                                           const value_type &, value_type>::type;
 
-        template <std::size_t I> struct Int { };
+            emit_as<storage_type>(std::forward<E>(e),
+                                  std::integral_constant<int, detail::element_kind<value_type, TChar, TCharTraits>::value>());
+        }
 
-        static void print_body(const element_type & c, ostream_type & stream)
+        template <typename S, typename E>
+        void emit_as(E && e, std::integral_constant<int, 0>)
         {
-            tuple_print(c, stream, Int<0>());
+            m_leaf << e;
         }
 
-        static void tuple_print(const element_type &, ostream_type &, Int<sizeof...(Args)>)
+        template <typename S, typename E>
+        void emit_as(E && e, std::integral_constant<int, 1>)
         {
+            using value_type = typename std::remove_cv<typename std::remove_reference<E>::type>::type;
+            push(detail::create<range_frame<value_type, S>>(m_resource, std::forward<E>(e)));
         }
 
-        static void tuple_print(const element_type & c, ostream_type & stream,
-                                typename std::conditional<sizeof...(Args) != 0, Int<0>, std::nullptr_t>::type)
+        template <typename S, typename E>
+        void emit_as(E && e, std::integral_constant<int, 2>)
         {
-            stream << std::get<0>(c);
-            tuple_print(c, stream, Int<1>());
+            using value_type = typename std::remove_cv<typename std::remove_reference<E>::type>::type;
+            push(detail::create<tuple_frame<value_type, S>>(m_resource, std::forward<E>(e)));
         }
 
-        template <std::size_t N>
-        static void tuple_print(const element_type & c, ostream_type & stream, Int<N>)
+        void push(frame * f)
         {
-            if (print_container_helper<T, TChar, TCharTraits, TDelimiters>::delimiters_type::values.delimiter != NULL)
-                stream << print_container_helper<T, TChar, TCharTraits, TDelimiters>::delimiters_type::values.delimiter;
-
-            stream << std::get<N>(c);
+            f->parent = m_top;
+            m_top = f;
+        }
 
-            tuple_print(c, stream, Int<N + 1>());
+        void pop()
+        {
+            frame * const f = m_top;
+            m_top = f->parent;
+            f->destroy(m_resource);
         }
+
+        frame * m_top;
+        const detail::resource_type m_resource;
+        string_type m_pending;
+        std::size_t m_offset;
+        detail::appending_streambuf<TChar, TCharTraits, detail::temp_allocator<TChar>> m_buf;
+        ostream_type m_leaf;
     };
 
-    // Prints a print_container_helper to the specified stream.
 
-    template<typename T, typename TChar, typename TCharTraits, typename TDelimiters>
-    inline std::basic_ostream<TChar, TCharTraits> & operator<<(
-        std::basic_ostream<TChar, TCharTraits> & stream,
-        const print_container_helper<T, TChar, TCharTraits, TDelimiters> & helper)
+    namespace detail
     {
-        helper(stream);
-        return stream;
+        template <typename TChar, typename TAllocator, typename T>
+        void format_into(std::basic_string<TChar, std::char_traits<TChar>, TAllocator> & s, const T & x)
+        {
+            appending_streambuf<TChar, std::char_traits<TChar>, TAllocator> buf(s);
+            std::basic_ostream<TChar, std::char_traits<TChar>> stream(&buf);
+            stream << x;
+        }
     }
 
+    // Formats x into a string, as "stream << x" would.
+    // Usage: std::string s = pretty_print::to_string(x);  or  std::wstring s = pretty_print::to_string<wchar_t>(x);
 
-    // Basic is_container template; specialize to derive from std::true_type for all desired container types
-
-    template <typename T>
-    struct is_container : public std::integral_constant<bool,
-                                                        detail::has_const_iterator<T>::value &&
-                                                        detail::has_begin_end<T>::beg_value  &&
-                                                        detail::has_begin_end<T>::end_value> { };
-
-    template <typename T, std::size_t N>
-    struct is_container<T[N]> : std::true_type { };
+    template <typename TChar = char, typename T>
+    inline std::basic_string<TChar> to_string(const T & x)
+    {
+        std::basic_string<TChar> s;
+        detail::format_into(s, x);
+        return s;
+    }
 
-    template <std::size_t N>
-    struct is_container<char[N]> : std::false_type { };
+#if PRETTY_PRINT_HAS_PMR
+    // The same, with the string allocated from the given memory resource.
+    // Usage: std::pmr::string s = pretty_print::to_string(x, &arena);
 
-    template <typename T>
-    struct is_container<std::valarray<T>> : std::true_type { };
+    template <typename TChar = char, typename T>
+    inline std::pmr::basic_string<TChar> to_string(const T & x, std::pmr::memory_resource * resource)
+    {
+        std::pmr::basic_string<TChar> s(resource);
+        detail::format_into(s, x);
+        return s;
+    }
+#endif
 
-    template <typename T1, typename T2>
-    struct is_container<std::pair<T1, T2>> : std::true_type { };
 
-    template <typename ...Args>
-    struct is_container<std::tuple<Args...>> : std::true_type { };
+#if __cplusplus >= 201703L
+    // Text produced at compile time by static_string(); it is written to a stream
+    // with a single write().
 
+    template <std::size_t N>
+    struct static_text
+    {
+        static constexpr std::size_t size() { return N; }
+        constexpr const char * c_str() const { return m_data; }
+        constexpr std::string_view view() const { return std::string_view(m_data, N); }
 
-    // Default delimiters
+        char m_data[N + 1];
+    };
 
-    template <typename T> struct delimiters<T, char> { static const delimiters_values<char> values; };
-    template <typename T> const delimiters_values<char> delimiters<T, char>::values = { "[", ", ", "]" };
-    template <typename T> struct delimiters<T, wchar_t> { static const delimiters_values<wchar_t> values; };
-    template <typename T> const delimiters_values<wchar_t> delimiters<T, wchar_t>::values = { L"[", L", ", L"]" };
+    template <typename TCharTraits, std::size_t N>
+    inline std::basic_ostream<char, TCharTraits> & operator<<(std::basic_ostream<char, TCharTraits> & stream, const static_text<N> & t)
+    {
+        return stream.write(t.m_data, static_cast<std::streamsize>(N));
+    }
 
+    namespace detail
+    {
+        // Compile-time formatting with the default delimiters. The writer only counts
+        // when out is null, so the same pass gives the size and then the text.
 
-    // Delimiters for (multi)set and unordered_(multi)set
+        struct static_writer
+        {
+            constexpr void put(char c)
+            {
+                if (out != nullptr) out[n] = c;
+                ++n;
+            }
 
-    template <typename T, typename TComp, typename TAllocator>
-    struct delimiters< ::std::set<T, TComp, TAllocator>, char> { static const delimiters_values<char> values; };
+            constexpr void put(const char * p)
+            {
+                while (*p != '\0') put(*p++);
+            }
 
-    template <typename T, typename TComp, typename TAllocator>
-    const delimiters_values<char> delimiters< ::std::set<T, TComp, TAllocator>, char>::values = { "{", ", ", "}" };
+            char * out;
+            std::size_t n;
+        };
 
-    template <typename T, typename TComp, typename TAllocator>
-    struct delimiters< ::std::set<T, TComp, TAllocator>, wchar_t> { static const delimiters_values<wchar_t> values; };
+        template <typename T> struct dependent_false : std::false_type { };
 
-    template <typename T, typename TComp, typename TAllocator>
-    const delimiters_values<wchar_t> delimiters< ::std::set<T, TComp, TAllocator>, wchar_t>::values = { L"{", L", ", L"}" };
+        template <typename T>
+        constexpr void static_format(static_writer & w, const T & x);
 
-    template <typename T, typename TComp, typename TAllocator>
-    struct delimiters< ::std::multiset<T, TComp, TAllocator>, char> { static const delimiters_values<char> values; };
+        template <typename T, std::size_t ...I>
+        constexpr void static_format_tuple(static_writer & w, const T & t, index_sequence<I...>)
+        {
+            w.put('(');
+            ((I == 0 ? void() : w.put(", "), static_format(w, std::get<I>(t))), ...);
+            w.put(')');
+        }
 
-    template <typename T, typename TComp, typename TAllocator>
-    const delimiters_values<char> delimiters< ::std::multiset<T, TComp, TAllocator>, char>::values = { "{", ", ", "}" };
+        template <typename T>
+        constexpr void static_format(static_writer & w, const T & x)
+        {
+            if constexpr (std::is_same<T, bool>::value)
+            {
+                w.put(x ? '1' : '0');
+            }
+            else if constexpr (std::is_same<T, char>::value || std::is_same<T, signed char>::value || std::is_same<T, unsigned char>::value)
+            {
+                w.put(static_cast<char>(x));
+            }
+            else if constexpr (std::is_integral<T>::value && !std::is_same<T, wchar_t>::value &&
+                               !std::is_same<T, char16_t>::value && !std::is_same<T, char32_t>::value)
+            {
+                unsigned long long u = static_cast<unsigned long long>(x);
+                if constexpr (std::is_signed<T>::value)
+                {
+                    if (x < 0)
+                    {
+                        w.put('-');
+                        u = 0ULL - u;
+                    }
+                }
 
-    template <typename T, typename TComp, typename TAllocator>
-    struct delimiters< ::std::multiset<T, TComp, TAllocator>, wchar_t> { static const delimiters_values<wchar_t> values; };
+                char digits[20] = { };
+                std::size_t k = 0;
+                do { digits[k++] = static_cast<char>('0' + u % 10); u /= 10; } while (u != 0);
+                while (k != 0) w.put(digits[--k]);
+            }
+            else if constexpr (std::is_same<T, const char *>::value || std::is_same<T, char *>::value)
+            {
+                w.put(x);
+            }
+            else if constexpr (std::is_array<T>::value && std::is_same<typename std::remove_cv<typename std::remove_extent<T>::type>::type, char>::value)
+            {
+                w.put(static_cast<const char *>(x));
+            }
+            else if constexpr (std::is_same<T, std::string_view>::value)
+            {
+                for (char c : x) w.put(c);
+            }
+            else if constexpr (element_kind<T, char, std::char_traits<char>>::value == 2)
+            {
+                static_format_tuple(w, x, typename make_index_sequence<std::tuple_size<T>::value>::type());
+            }
+            else if constexpr (element_kind<T, char, std::char_traits<char>>::value == 1)
+            {
+                w.put('[');
+                bool first = true;
+                for (const auto & e : x)
+                {
+                    if (!first) w.put(", ");
+                    static_format(w, e);
+                    first = false;
+                }
+                w.put(']');
+            }
+            else
+            {
+                static_assert(dependent_false<T>::value, "static_string() supports integers, characters, strings, arrays, "
+                                                         "pairs and tuples; format other types at run time");
+            }
+        }
 
-    template <typename T, typename TComp, typename TAllocator>
-    const delimiters_values<wchar_t> delimiters< ::std::multiset<T, TComp, TAllocator>, wchar_t>::values = { L"{", L", ", L"}" };
+        template <typename T>
+        constexpr std::size_t static_size(const T & x)
+        {
+            static_writer w = { nullptr, 0 };
+            static_format(w, x);
+            return w.n;
+        }
 
-    template <typename T, typename THash, typename TEqual, typename TAllocator>
-    struct delimiters< ::std::unordered_set<T, THash, TEqual, TAllocator>, char> { static const delimiters_values<char> values; };
+        template <std::size_t N, typename T>
+        constexpr static_text<N> static_fill(const T & x)
+        {
+            static_text<N> t = { };
+            static_writer w = { t.m_data, 0 };
+            static_format(w, x);
+            return t;
+        }
 
-    template <typename T, typename THash, typename TEqual, typename TAllocator>
-    const delimiters_values<char> delimiters< ::std::unordered_set<T, THash, TEqual, TAllocator>, char>::values = { "{", ", ", "}" };
+        template <const auto & X>
+        struct static_string_holder
+        {
+            static constexpr static_text<static_size(X)> value = static_fill<static_size(X)>(X);
+        };
 
-    template <typename T, typename THash, typename TEqual, typename TAllocator>
-    struct delimiters< ::std::unordered_set<T, THash, TEqual, TAllocator>, wchar_t> { static const delimiters_values<wchar_t> values; };
+    }  // namespace detail
 
-    template <typename T, typename THash, typename TEqual, typename TAllocator>
-    const delimiters_values<wchar_t> delimiters< ::std::unordered_set<T, THash, TEqual, TAllocator>, wchar_t>::values = { L"{", L", ", L"}" };
+    // The text "std::cout << x" prints for a constant x, computed at compile time.
+    // x must have static storage duration, and must consist of integers, characters,
+    // strings, arrays, pairs and tuples; floating-point values are not supported.
+    // The default delimiters are used, even where delimiters is specialized.
+    // Usage: static constexpr std::array<int, 3> table = { 1, 2, 3 };
+    //        std::cout << pretty_print::static_string<table>();  (One write of "[1, 2, 3]".)
 
-    template <typename T, typename THash, typename TEqual, typename TAllocator>
-    struct delimiters< ::std::unordered_multiset<T, THash, TEqual, TAllocator>, char> { static const delimiters_values<char> values; };
+    template <const auto & X>
+    constexpr const auto & static_string()
+    {
+        return detail::static_string_holder<X>::value;
+    }
+#endif
 
-    template <typename T, typename THash, typename TEqual, typename TAllocator>
-    const delimiters_values<char> delimiters< ::std::unordered_multiset<T, THash, TEqual, TAllocator>, char>::values = { "{", ", ", "}" };
 
-    template <typename T, typename THash, typename TEqual, typename TAllocator>
-    struct delimiters< ::std::unordered_multiset<T, THash, TEqual, TAllocator>, wchar_t> { static const delimiters_values<wchar_t> values; };
+#if PRETTY_PRINT_HAS_COROUTINES
+    // The awaitable result of async_write(). The write starts when the task is
+    // awaited, and the awaiting coroutine is resumed once everything is written.
 
-    template <typename T, typename THash, typename TEqual, typename TAllocator>
-    const delimiters_values<wchar_t> delimiters< ::std::unordered_multiset<T, THash, TEqual, TAllocator>, wchar_t>::values = { L"{", L", ", L"}" };
+    class write_task
+    {
+    public:
+        struct promise_type
+        {
+            struct final_awaiter
+            {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept { return h.promise().continuation; }
+                void await_resume() noexcept { }
+            };
 
+            write_task get_return_object() { return write_task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return { }; }
+            final_awaiter final_suspend() noexcept { return { }; }
+            void return_void() { }
+            void unhandled_exception() { error = std::current_exception(); }
 
-    // Delimiters for pair and tuple
+#if PRETTY_PRINT_HAS_PMR
+            // The coroutine frame is allocated from the resource passed to async_write().
+            // The resource is remembered in front of the frame for deallocation.
 
-    template <typename T1, typename T2> struct delimiters<std::pair<T1, T2>, char> { static const delimiters_values<char> values; };
-    template <typename T1, typename T2> const delimiters_values<char> delimiters<std::pair<T1, T2>, char>::values = { "(", ", ", ")" };
-    template <typename T1, typename T2> struct delimiters< ::std::pair<T1, T2>, wchar_t> { static const delimiters_values<wchar_t> values; };
-    template <typename T1, typename T2> const delimiters_values<wchar_t> delimiters< ::std::pair<T1, T2>, wchar_t>::values = { L"(", L", ", L")" };
+            static const std::size_t header_size = alignof(std::max_align_t);
 
-    template <typename ...Args> struct delimiters<std::tuple<Args...>, char> { static const delimiters_values<char> values; };
-    template <typename ...Args> const delimiters_values<char> delimiters<std::tuple<Args...>, char>::values = { "(", ", ", ")" };
-    template <typename ...Args> struct delimiters< ::std::tuple<Args...>, wchar_t> { static const delimiters_values<wchar_t> values; };
-    template <typename ...Args> const delimiters_values<wchar_t> delimiters< ::std::tuple<Args...>, wchar_t>::values = { L"(", L", ", L")" };
+            template <typename Sink, typename T>
+            static void * operator new(std::size_t n, Sink &, const T &, std::pmr::memory_resource * r)
+            {
+                char * const p = static_cast<char *>(r->allocate(n + header_size, alignof(std::max_align_t)));
+                *reinterpret_cast<std::pmr::memory_resource **>(p) = r;
+                return p + header_size;
+            }
 
+            static void operator delete(void * frame, std::size_t n)
+            {
+                char * const p = static_cast<char *>(frame) - header_size;
+                (*reinterpret_cast<std::pmr::memory_resource **>(p))->deallocate(p, n + header_size, alignof(std::max_align_t));
+            }
+#endif
 
-    // Type-erasing helper class for easy use of custom delimiters.
-    // Requires TCharTraits = std::char_traits<TChar> and TChar = char or wchar_t, and MyDelims needs to be defined for TChar.
-    // Usage: "cout << pretty_print::custom_delims<MyDelims>(x)".
+            std::coroutine_handle<> continuation;
+            std::exception_ptr error;
+        };
 
-    struct custom_delims_base
-    {
-        virtual ~custom_delims_base() { }
-        virtual std::ostream & stream(::std::ostream &) = 0;
-        virtual std::wostream & stream(::std::wostream &) = 0;
-    };
+        write_task(write_task && other) noexcept : m_h(other.m_h) { other.m_h = nullptr; }
+        write_task & operator=(write_task &&) = delete;
+        ~write_task() { if (m_h) m_h.destroy(); }
 
-    template <typename T, typename Delims>
-    struct custom_delims_wrapper : custom_delims_base
-    {
-        custom_delims_wrapper(const T & t_) : t(t_) { }
+        bool await_ready() const noexcept { return false; }
 
-        std::ostream & stream(std::ostream & s)
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
         {
-            return s << print_container_helper<T, char, std::char_traits<char>, Delims>(t);
+            m_h.promise().continuation = awaiting;
+            return m_h;
         }
 
-        std::wostream & stream(std::wostream & s)
+        void await_resume()
         {
-            return s << print_container_helper<T, wchar_t, std::char_traits<wchar_t>, Delims>(t);
+            if (m_h.promise().error) std::rethrow_exception(m_h.promise().error);
         }
 
     private:
-        const T & t;
+        explicit write_task(std::coroutine_handle<promise_type> h) : m_h(h) { }
+
+        std::coroutine_handle<promise_type> m_h;
     };
 
-    template <typename Delims>
-    struct custom_delims
+    // Writes x to an asynchronous sink, suspending whenever the sink is full.
+    // The sink must provide:
+    //   using char_type = ...;
+    //   std::size_t write_some(const char_type * p, std::size_t n);  // non-blocking; returns the number accepted
+    //   <awaitable> writable();                                      // completes when there is room again
+    // Usage: co_await pretty_print::async_write(sink, x);  or, with std::pmr: async_write(sink, x, &arena);
+    //
+    // The task holds x and the sink by reference and does not start until it is
+    // awaited. Await it in the same full-expression, as above; a task stored for
+    // later must not outlive x, so "auto t = async_write(sink, make_vector());"
+    // dangles.
+
+#if defined(__GNUC__) && !defined(__clang__)
+    // GCC does not recognize the coroutine frame's operator new/delete pair as matching.
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+    template <typename Sink, typename T>
+    write_task async_write(Sink & sink, const T & x, detail::resource_type resource = detail::default_resource())
     {
-        template <typename Container>
-        custom_delims(const Container & c) : base(new custom_delims_wrapper<Container, Delims>(c)) { }
+        using char_type = typename Sink::char_type;
 
-        std::unique_ptr<custom_delims_base> base;
-    };
+        incremental_printer<char_type> printer(x, resource);
+        char_type buffer[512];
 
-    template <typename TChar, typename TCharTraits, typename Delims>
-    inline std::basic_ostream<TChar, TCharTraits> & operator<<(std::basic_ostream<TChar, TCharTraits> & s, const custom_delims<Delims> & p)
-    {
-        return p.base->stream(s);
+        while (!printer.done())
+        {
+            const std::size_t n = printer.pump(buffer, sizeof buffer / sizeof buffer[0]);
+
+            for (std::size_t written = 0; ; )
+            {
+                written += sink.write_some(buffer + written, n - written);
+                if (written == n) break;
+                co_await sink.writable();
+            }
+        }
     }
 
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic pop
+#endif
+#endif
+
 
     // A wrapper for a C-style array given as pointer-plus-size.
     // Usage: std::cout << pretty_print_array(arr, n) << std::endl;
@@ -406,6 +815,384 @@ namespace pretty_print
         const size_type n;
     };
 
+
+    // Projections applied element-wise by the projection wrappers below.
+
+    struct first_projection
+    {
+        template <typename P>
+        auto operator()(const P & p) const -> decltype((p.first)) { return p.first; }
+    };
+
+    struct second_projection
+    {
+        template <typename P>
+        auto operator()(const P & p) const -> decltype((p.second)) { return p.second; }
+    };
+
+    template <typename C, typename M>
+    struct member_projection
+    {
+        member_projection() : m_pm(nullptr) { }
+        member_projection(M C::* pm) : m_pm(pm) { }
+        const M & operator()(const C & c) const { return c.*m_pm; }
+
+    private:
+        M C::* m_pm;
+    };
+
+
+    // An iterator adaptor which dereferences to the projection of the underlying element.
+    // Nothing is copied; the projection is applied as the printer walks the container.
+
+    template <typename TIter, typename TProj>
+    struct projection_iterator
+    {
+        typedef std::forward_iterator_tag iterator_category;
+        typedef decltype(std::declval<const TProj &>()(*std::declval<TIter>())) reference;
+        typedef typename std::decay<reference>::type value_type;
+        typedef typename std::iterator_traits<TIter>::difference_type difference_type;
+        typedef const value_type * pointer;
+
+        projection_iterator() : m_it(), m_proj() { }
+        projection_iterator(TIter it, TProj proj) : m_it(it), m_proj(proj) { }
+
+        reference operator*() const { return m_proj(*m_it); }
+        projection_iterator & operator++() { ++m_it; return *this; }
+        projection_iterator operator++(int) { projection_iterator tmp(*this); ++m_it; return tmp; }
+
+        friend bool operator==(const projection_iterator & a, const projection_iterator & b) { return a.m_it == b.m_it; }
+        friend bool operator!=(const projection_iterator & a, const projection_iterator & b) { return a.m_it != b.m_it; }
+
+    private:
+        TIter m_it;
+        TProj m_proj;
+    };
+
+
+    // A wrapper presenting a container through a projection of its elements.
+    // Usage: std::cout << pretty_print::keys(m) << std::endl;  (Prints the keys of map m.)
+
+    template <typename T, typename TProj>
+    struct projection_wrapper
+    {
+        typedef projection_iterator<typename T::const_iterator, TProj> const_iterator;
+        typedef typename const_iterator::value_type value_type;
+
+        const_iterator begin() const
+        {
+            return const_iterator(m_c.begin(), m_proj);
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator(m_c.end(), m_proj);
+        }
+
+        projection_wrapper(const T & c, TProj proj) : m_c(c), m_proj(proj) { }
+
+    private:
+        const T & m_c;
+        const TProj m_proj;
+    };
+
+    template <typename T>
+    inline projection_wrapper<T, first_projection> keys(const T & m)
+    {
+        return projection_wrapper<T, first_projection>(m, first_projection());
+    }
+
+    template <typename T>
+    inline projection_wrapper<T, second_projection> values(const T & m)
+    {
+        return projection_wrapper<T, second_projection>(m, second_projection());
+    }
+
+    template <typename T, typename C, typename M>
+    inline projection_wrapper<T, member_projection<C, M>> project(const T & c, M C::* pm)
+    {
+        return projection_wrapper<T, member_projection<C, M>>(c, member_projection<C, M>(pm));
+    }
+
+
+    // An iterator which walks several iterators in lockstep and dereferences to
+    // a tuple of references to the current elements. Iteration stops as soon as
+    // any of the underlying iterators reaches its end.
+
+    template <typename ...TIters>
+    struct zip_iterator
+    {
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::tuple<typename std::iterator_traits<TIters>::reference...> reference;
+        typedef reference value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type * pointer;
+
+        zip_iterator() : m_its() { }
+        zip_iterator(TIters... its) : m_its(its...) { }
+
+        reference operator*() const { return deref(typename detail::make_index_sequence<sizeof...(TIters)>::type()); }
+        zip_iterator & operator++() { advance(typename detail::make_index_sequence<sizeof...(TIters)>::type()); return *this; }
+        zip_iterator operator++(int) { zip_iterator tmp(*this); ++*this; return tmp; }
+
+        friend bool operator==(const zip_iterator & a, const zip_iterator & b)
+        {
+            return a.any_equal(b, typename detail::make_index_sequence<sizeof...(TIters)>::type());
+        }
+
+        friend bool operator!=(const zip_iterator & a, const zip_iterator & b) { return !(a == b); }
+
+    private:
+        template <std::size_t ...I>
+        reference deref(detail::index_sequence<I...>) const
+        {
+            return reference(*std::get<I>(m_its)...);
+        }
+
+        template <std::size_t ...I>
+        void advance(detail::index_sequence<I...>)
+        {
+            detail::swallow{ (++std::get<I>(m_its), 0)... };
+        }
+
+        template <std::size_t ...I>
+        bool any_equal(const zip_iterator & other, detail::index_sequence<I...>) const
+        {
+            bool const eq[] = { false, (std::get<I>(m_its) == std::get<I>(other.m_its))... };
+            for (bool e : eq) { if (e) return true; }
+            return false;
+        }
+
+        std::tuple<TIters...> m_its;
+    };
+
+
+    // A wrapper presenting several parallel containers as a single sequence of tuples.
+    // Prints exactly like the equivalent container of std::tuple, without building one.
+    // Usage: std::cout << pretty_print::zip(a, b, c) << std::endl;  (Prints [(a0, b0, c0), ...].)
+
+    template <typename ...Ts>
+    struct zip_wrapper
+    {
+        typedef zip_iterator<decltype(std::begin(std::declval<const Ts &>()))...> const_iterator;
+        typedef typename const_iterator::value_type value_type;
+
+        const_iterator begin() const
+        {
+            return make_begin(typename detail::make_index_sequence<sizeof...(Ts)>::type());
+        }
+
+        const_iterator end() const
+        {
+            return make_end(typename detail::make_index_sequence<sizeof...(Ts)>::type());
+        }
+
+        zip_wrapper(const Ts & ...cs) : m_cs(cs...) { }
+
+    private:
+        template <std::size_t ...I>
+        const_iterator make_begin(detail::index_sequence<I...>) const
+        {
+            return const_iterator(std::begin(std::get<I>(m_cs))...);
+        }
+
+        template <std::size_t ...I>
+        const_iterator make_end(detail::index_sequence<I...>) const
+        {
+            return const_iterator(std::end(std::get<I>(m_cs))...);
+        }
+
+        const std::tuple<const Ts &...> m_cs;
+    };
+
+    template <typename T, typename ...Ts>
+    inline zip_wrapper<T, Ts...> zip(const T & c, const Ts & ...cs)
+    {
+        return zip_wrapper<T, Ts...>(c, cs...);
+    }
+
+
+    // A wrapper presenting only those elements of a container which satisfy a predicate.
+    // The predicate is evaluated while printing, and at most "cap" elements are printed.
+    // The number of elements left out by the most recent traversal is available via skipped().
+    // That count is a mutable member which begin() resets, so one wrapper must not be
+    // printed (or iterated) from two threads at once; give each thread its own.
+    // Usage: auto f = pretty_print::filter(v, pred, 10); std::cout << f; std::cout << f.skipped();
+
+    template <typename T, typename TPred, typename TStorage = const T &>
+    struct filter_wrapper
+    {
+        typedef decltype(std::begin(std::declval<const T &>())) base_iterator;
+
+        struct const_iterator
+        {
+            typedef std::forward_iterator_tag iterator_category;
+            typedef typename std::iterator_traits<base_iterator>::reference reference;
+            typedef typename std::iterator_traits<base_iterator>::value_type value_type;
+            typedef typename std::iterator_traits<base_iterator>::difference_type difference_type;
+            typedef typename std::iterator_traits<base_iterator>::pointer pointer;
+
+            const_iterator() : m_it(), m_end(), m_owner(nullptr), m_taken(0) { }
+
+            const_iterator(base_iterator it, base_iterator last, const filter_wrapper * owner)
+            : m_it(it), m_end(last), m_owner(owner), m_taken(0)
+            {
+                satisfy();
+            }
+
+            reference operator*() const { return *m_it; }
+            const_iterator & operator++() { ++m_it; ++m_taken; satisfy(); return *this; }
+            const_iterator operator++(int) { const_iterator tmp(*this); ++*this; return tmp; }
+
+            friend bool operator==(const const_iterator & a, const const_iterator & b) { return a.m_it == b.m_it; }
+            friend bool operator!=(const const_iterator & a, const const_iterator & b) { return a.m_it != b.m_it; }
+
+        private:
+            // Advances to the next printable element. Once the cap is reached, the
+            // remainder is only counted, so the traversal still makes a single pass.
+
+            void satisfy()
+            {
+                for ( ; m_it != m_end; ++m_it)
+                {
+                    if (m_taken < m_owner->m_cap && m_owner->m_pred(*m_it)) return;
+                    ++m_owner->m_skipped;
+                }
+            }
+
+            base_iterator m_it;
+            base_iterator m_end;
+            const filter_wrapper * m_owner;
+            std::size_t m_taken;
+        };
+
+        typedef typename const_iterator::value_type value_type;
+
+        const_iterator begin() const
+        {
+            m_skipped = 0;
+            return const_iterator(std::begin(m_c), std::end(m_c), this);
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator(std::end(m_c), std::end(m_c), this);
+        }
+
+        std::size_t skipped() const { return m_skipped; }
+
+        filter_wrapper(const T & c, TPred pred, std::size_t cap)
+        : m_c(c), m_pred(pred), m_cap(cap), m_skipped(0) { }
+
+    private:
+        TStorage m_c;
+        const TPred m_pred;
+        const std::size_t m_cap;
+        mutable std::size_t m_skipped;
+    };
+
+    struct changed_predicate
+    {
+        template <typename Tuple>
+        bool operator()(const Tuple & t) const { return !(std::get<0>(t) == std::get<1>(t)); }
+    };
+
+    template <typename T, typename TPred>
+    inline filter_wrapper<T, TPred> filter(const T & c, TPred pred, std::size_t cap = std::size_t(-1))
+    {
+        return filter_wrapper<T, TPred>(c, pred, cap);
+    }
+
+    // Prints the pairs (a[i], b[i]) of corresponding elements which differ.
+    // Like zip(), it stops at the end of the shorter container: elements which only
+    // the longer one has are neither printed nor counted by skipped(), so compare
+    // the sizes separately where they may differ.
+
+    template <typename T1, typename T2>
+    inline filter_wrapper<zip_wrapper<T1, T2>, changed_predicate, zip_wrapper<T1, T2>>
+    where_changed(const T1 & a, const T2 & b, std::size_t cap = std::size_t(-1))
+    {
+        return filter_wrapper<zip_wrapper<T1, T2>, changed_predicate, zip_wrapper<T1, T2>>(
+            zip_wrapper<T1, T2>(a, b), changed_predicate(), cap);
+    }
+
+
+
+    // A wrapper for an iterator pair, which may consist of single-pass input iterators.
+    // Elements are streamed to the output as the iterator produces them, so traversing
+    // the wrapper consumes the source and it should be printed only once.
+    // Usage: std::cout << pretty_print::range(cursor.begin(), cursor.end()) << std::endl;
+
+    template <typename TIter, typename TSentinel = TIter>
+    struct iterator_range_wrapper
+    {
+        typedef TIter const_iterator;
+
+        const_iterator begin() const
+        {
+            return m_first;
+        }
+
+        TSentinel end() const
+        {
+            return m_last;
+        }
+
+        iterator_range_wrapper(TIter first, TSentinel last) : m_first(first), m_last(last) { }
+
+    private:
+        const TIter m_first;
+        const TSentinel m_last;
+    };
+
+    template <typename TIter, typename TSentinel>
+    inline iterator_range_wrapper<TIter, TSentinel> range(TIter first, TSentinel last)
+    {
+        return iterator_range_wrapper<TIter, TSentinel>(first, last);
+    }
+
+    // Streams the values of type T extracted from an input stream until extraction fails.
+    // Usage: std::cout << pretty_print::range<int>(std::cin) << std::endl;
+
+    template <typename T, typename TChar, typename TCharTraits>
+    inline iterator_range_wrapper<std::istream_iterator<T, TChar, TCharTraits>>
+    range(std::basic_istream<TChar, TCharTraits> & is)
+    {
+        return iterator_range_wrapper<std::istream_iterator<T, TChar, TCharTraits>>(
+            std::istream_iterator<T, TChar, TCharTraits>(is), std::istream_iterator<T, TChar, TCharTraits>());
+    }
+
+#if PRETTY_PRINT_HAS_RANGES
+    // A wrapper for move-only or non-const-iterable input ranges, such as std::generator,
+    // which refers to the range and consumes it when printed.
+    // Usage: auto g = make_generator(); std::cout << pretty_print::range(g) << std::endl;
+
+    template <std::ranges::input_range R>
+    struct input_range_wrapper
+    {
+        auto begin() const
+        {
+            return std::ranges::begin(*m_r);
+        }
+
+        auto end() const
+        {
+            return std::ranges::end(*m_r);
+        }
+
+        input_range_wrapper(R & r) : m_r(&r) { }
+
+    private:
+        R * const m_r;
+    };
+
+    template <std::ranges::input_range R>
+    inline input_range_wrapper<R> range(R & r)
+    {
+        return input_range_wrapper<R>(r);
+    }
+#endif
+
 }   // namespace pretty_print
 
 
@@ -424,22 +1211,10 @@ bucket_print(const T & m, typename T::size_type n)
 }
 
 
-// Main magic entry point: An overload snuck into namespace std.
-// Can we do better?
-
-namespace std
-{
-    // Prints a container to the stream using default delimiters
-
-    template<typename T, typename TChar, typename TCharTraits>
-    inline typename enable_if< ::pretty_print::is_container<T>::value,
-                              basic_ostream<TChar, TCharTraits> &>::type
-    operator<<(basic_ostream<TChar, TCharTraits> & stream, const T & container)
-    {
-        return stream << ::pretty_print::print_container_helper<T, TChar, TCharTraits>(container);
-    }
-}
-
+// Opt-in: use the printers prebuilt by prettyprint_instances.cpp.
 
+#ifdef PRETTY_PRINT_EXTERN_TEMPLATES
+#  include "prettyprint_extern.hpp"
+#endif
 
 #endif  // H_PRETTY_PRINT
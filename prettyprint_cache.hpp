@@ -0,0 +1,345 @@
+//          Copyright Louis Delacroix 2010 - 2014.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+// A cache of formatted containers, for large containers which rarely change
+// but are printed often.
+//
+// Usage:
+// pretty_print::format_cache<> cache(1 << 20);      // keep up to 1 MiB of text
+// std::cout << cache(routes, routes_generation);    // formatted once per generation
+//
+// The caller bumps the generation whenever the container changes; generations
+// only ever increase, and a cache entry is never replaced by an older one. An entry is
+// keyed on the container's address and type and on the stream's format flags,
+// precision, fill and width; the stream's locale is assumed not to change.
+
+#ifndef H_PRETTY_PRINT_CACHE
+#define H_PRETTY_PRINT_CACHE
+
+#include "prettyprint_core.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+
+#if __cplusplus >= 201703L
+#  include <shared_mutex>
+#endif
+
+namespace pretty_print
+{
+    namespace detail
+    {
+        // Readers share the lock where std::shared_mutex is available.
+
+#if __cplusplus >= 201703L
+        using cache_mutex = std::shared_mutex;
+        using cache_read_lock = std::shared_lock<std::shared_mutex>;
+#else
+        using cache_mutex = std::mutex;
+        using cache_read_lock = std::unique_lock<std::mutex>;
+#endif
+
+    }  // namespace detail
+
+    template <typename T, typename TChar, typename TCharTraits>
+    struct cached_print_wrapper;
+
+    // Formatted text of containers, evicted least recently used first once the
+    // text exceeds the byte budget. All members may be called concurrently. A hit
+    // takes the lock shared and writes the text outside of it; a miss formats the
+    // container without the lock and then takes it exclusively to insert.
+    //
+    // The entries form a list in order of insertion. As a hit only holds the lock
+    // shared, it marks its entry as referenced instead of moving it; eviction takes
+    // entries from the old end, and moves a referenced one back to the new end once
+    // (the "second chance" approximation of LRU), so each eviction is O(1) amortized.
+
+    template <typename TChar = char, typename TCharTraits = ::std::char_traits<TChar>>
+    class format_cache
+    {
+    public:
+        using string_type = std::basic_string<TChar, TCharTraits>;
+        using ostream_type = std::basic_ostream<TChar, TCharTraits>;
+
+        explicit format_cache(std::size_t byte_budget)
+        : m_budget(byte_budget), m_bytes(0), m_hits(0), m_misses(0), m_evictions(0)
+        {
+            m_list.prev = m_list.next = &m_list;
+        }
+
+        format_cache(const format_cache &) = delete;
+        format_cache & operator=(const format_cache &) = delete;
+
+        template <typename T>
+        cached_print_wrapper<T, TChar, TCharTraits> operator()(const T & x, std::uint64_t generation)
+        {
+            return cached_print_wrapper<T, TChar, TCharTraits>(*this, x, generation);
+        }
+
+        // Writes x as "stream << x" would, from the cache if it holds generation of x.
+
+        template <typename T>
+        void print(ostream_type & stream, const T & x, std::uint64_t generation)
+        {
+            const key k = make_key(stream, x);
+            std::shared_ptr<const string_type> text = find(k, generation);
+
+            if (text)
+            {
+                m_hits.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+            {
+                m_misses.fetch_add(1, std::memory_order_relaxed);
+                text = format(stream, x);
+                insert(k, generation, text);
+            }
+
+            stream.width(0);
+            stream.write(text->data(), static_cast<std::streamsize>(text->size()));
+        }
+
+        // Drops all entries for x, e.g. before it is destroyed and its address reused.
+
+        template <typename T>
+        void erase(const T & x)
+        {
+            std::unique_lock<detail::cache_mutex> lock(m_mutex);
+            for (auto it = m_entries.begin(); it != m_entries.end(); )
+            {
+                if (it->first.address == static_cast<const void *>(&x) && *it->first.type == typeid(T))
+                    it = remove(it);
+                else
+                    ++it;
+            }
+        }
+
+        void clear()
+        {
+            std::unique_lock<detail::cache_mutex> lock(m_mutex);
+            m_entries.clear();
+            m_list.prev = m_list.next = &m_list;
+            m_bytes = 0;
+        }
+
+        std::size_t bytes() const
+        {
+            detail::cache_read_lock lock(m_mutex);
+            return m_bytes;
+        }
+
+        std::size_t size() const
+        {
+            detail::cache_read_lock lock(m_mutex);
+            return m_entries.size();
+        }
+
+        std::uint64_t hits() const { return m_hits.load(std::memory_order_relaxed); }
+        std::uint64_t misses() const { return m_misses.load(std::memory_order_relaxed); }
+        std::uint64_t evictions() const { return m_evictions.load(std::memory_order_relaxed); }
+
+    private:
+        struct key
+        {
+            const void * address;
+            const std::type_info * type;
+            std::ios_base::fmtflags flags;
+            std::streamsize precision;
+            std::streamsize width;
+            typename TCharTraits::int_type fill;
+
+            bool operator==(const key & other) const
+            {
+                return address == other.address && *type == *other.type && flags == other.flags &&
+                       precision == other.precision && width == other.width && fill == other.fill;
+            }
+        };
+
+        struct key_hash
+        {
+            std::size_t operator()(const key & k) const
+            {
+                std::size_t h = std::hash<const void *>()(k.address);
+                h = h * 31 + k.type->hash_code();
+                h = h * 31 + static_cast<std::size_t>(k.flags);
+                h = h * 31 + static_cast<std::size_t>(k.precision);
+                h = h * 31 + static_cast<std::size_t>(k.width);
+                return h * 31 + static_cast<std::size_t>(k.fill);
+            }
+        };
+
+        // A link of the eviction list; the list's head is a link without an entry.
+
+        struct link
+        {
+            link * prev;
+            link * next;
+        };
+
+        // The referenced flag is atomic, so that hits can set it under the shared lock.
+
+        struct entry : link
+        {
+            entry(std::uint64_t g, std::shared_ptr<const string_type> t)
+            : link(), generation(g), text(std::move(t)), referenced(false), k(nullptr)
+            { }
+
+            std::uint64_t generation;
+            std::shared_ptr<const string_type> text;
+            mutable std::atomic<bool> referenced;
+            const key * k;
+        };
+
+        using map_type = std::unordered_map<key, entry, key_hash>;
+
+        template <typename T>
+        static key make_key(const ostream_type & stream, const T & x)
+        {
+            key k = { static_cast<const void *>(&x), &typeid(T), stream.flags(), stream.precision(), stream.width(),
+                      TCharTraits::to_int_type(stream.fill()) };
+            return k;
+        }
+
+        static std::size_t cost(const string_type & text)
+        {
+            return text.size() * sizeof(TChar);
+        }
+
+        template <typename T>
+        static std::shared_ptr<const string_type> format(const ostream_type & stream, const T & x)
+        {
+            std::shared_ptr<string_type> text = std::make_shared<string_type>();
+            detail::appending_streambuf<TChar, TCharTraits> buf(*text);
+            ostream_type os(&buf);
+            os.flags(stream.flags());
+            os.precision(stream.precision());
+            os.fill(stream.fill());
+            os.width(stream.width());
+            os.imbue(stream.getloc());
+            os << print_container_helper<T, TChar, TCharTraits>(x);
+            return text;
+        }
+
+        std::shared_ptr<const string_type> find(const key & k, std::uint64_t generation) const
+        {
+            detail::cache_read_lock lock(m_mutex);
+            const auto it = m_entries.find(k);
+            if (it == m_entries.end() || it->second.generation != generation)
+                return std::shared_ptr<const string_type>();
+
+            if (!it->second.referenced.load(std::memory_order_relaxed))
+                it->second.referenced.store(true, std::memory_order_relaxed);
+            return it->second.text;
+        }
+
+        void insert(const key & k, std::uint64_t generation, const std::shared_ptr<const string_type> & text)
+        {
+            if (cost(*text) > m_budget) return;
+
+            std::unique_lock<detail::cache_mutex> lock(m_mutex);
+
+            // A miss for an old generation which finishes after one for a newer
+            // generation must not replace the newer text.
+
+            const auto old = m_entries.find(k);
+            if (old != m_entries.end())
+            {
+                if (old->second.generation >= generation) return;
+                remove(old);
+            }
+
+            while (m_bytes + cost(*text) > m_budget)
+            {
+                entry * const oldest = static_cast<entry *>(m_list.next);
+                unlink(oldest);
+                if (oldest->referenced.exchange(false, std::memory_order_relaxed))
+                {
+                    push_back(oldest);
+                }
+                else
+                {
+                    remove(m_entries.find(*oldest->k));
+                    m_evictions.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            const auto it = m_entries.emplace(std::piecewise_construct, std::forward_as_tuple(k),
+                                              std::forward_as_tuple(generation, text)).first;
+            it->second.k = &it->first;
+            push_back(&it->second);
+            m_bytes += cost(*text);
+        }
+
+        void push_back(link * l)
+        {
+            l->prev = m_list.prev;
+            l->next = &m_list;
+            m_list.prev->next = l;
+            m_list.prev = l;
+        }
+
+        static void unlink(link * l)
+        {
+            l->prev->next = l->next;
+            l->next->prev = l->prev;
+            l->prev = l->next = l;
+        }
+
+        typename map_type::iterator remove(typename map_type::iterator it)
+        {
+            unlink(&it->second);
+            m_bytes -= cost(*it->second.text);
+            return m_entries.erase(it);
+        }
+
+        const std::size_t m_budget;
+        mutable detail::cache_mutex m_mutex;
+        map_type m_entries;
+        link m_list;
+        std::size_t m_bytes;
+        std::atomic<std::uint64_t> m_hits;
+        std::atomic<std::uint64_t> m_misses;
+        std::atomic<std::uint64_t> m_evictions;
+    };
+
+    // Returned by format_cache::operator(); prints through the cache.
+
+    template <typename T, typename TChar, typename TCharTraits>
+    struct cached_print_wrapper
+    {
+        cached_print_wrapper(format_cache<TChar, TCharTraits> & cache, const T & x, std::uint64_t generation)
+        : m_cache(cache), m_x(x), m_generation(generation)
+        { }
+
+        void print(std::basic_ostream<TChar, TCharTraits> & stream) const
+        {
+            m_cache.print(stream, m_x, m_generation);
+        }
+
+    private:
+        format_cache<TChar, TCharTraits> & m_cache;
+        const T & m_x;
+        const std::uint64_t m_generation;
+    };
+
+    template <typename T, typename TChar, typename TCharTraits>
+    inline std::basic_ostream<TChar, TCharTraits> & operator<<(std::basic_ostream<TChar, TCharTraits> & stream,
+                                                               const cached_print_wrapper<T, TChar, TCharTraits> & w)
+    {
+        w.print(stream);
+        return stream;
+    }
+
+}   // namespace pretty_print
+
+#endif  // H_PRETTY_PRINT_CACHE
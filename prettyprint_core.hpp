@@ -0,0 +1,1033 @@
+//          Copyright Louis Delacroix 2010 - 2014.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+// A pretty printing library for C++: the core.
+//
+// Usage:
+// Include this header instead of prettyprint.hpp to print ranges, arrays and
+// pairs with the generic delimiters while parsing as little as possible. Add
+// the family headers for the types a translation unit prints:
+//   prettyprint_tuple.hpp          std::tuple
+//   prettyprint_set.hpp            braces for std::set and std::multiset
+//   prettyprint_unordered_set.hpp  braces for std::unordered_(multi)set
+//   prettyprint_valarray.hpp       std::valarray
+// A family header must be included before the first print of its types, and
+// consistently in all translation units which print them: a set printed without
+// prettyprint_set.hpp uses square brackets. prettyprint.hpp includes them all.
+
+#ifndef H_PRETTY_PRINT_CORE
+#define H_PRETTY_PRINT_CORE
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if __cplusplus >= 202002L
+#  include <ranges>
+#endif
+
+#if defined(__cpp_lib_ranges)
+#  define PRETTY_PRINT_HAS_RANGES 1
+#else
+#  define PRETTY_PRINT_HAS_RANGES 0
+#endif
+
+#if defined(__GNUC__)
+#  define PRETTY_PRINT_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#  define PRETTY_PRINT_NOINLINE __declspec(noinline)
+#else
+#  define PRETTY_PRINT_NOINLINE
+#endif
+
+// Define PRETTY_PRINT_ATOMIC_RECORDS to 1 to make the atomic_records manipulator
+// (see below) available. Off by default, so that a plain print does not pay for
+// the check of the stream's flag. Like the other switches, it must be the same
+// in all translation units of a program.
+
+#ifndef PRETTY_PRINT_ATOMIC_RECORDS
+#  define PRETTY_PRINT_ATOMIC_RECORDS 0
+#endif
+
+// Define PRETTY_PRINT_INSTRUMENTATION to 1 to collect per-type statistics of
+// container printing (see print_stats below). Off by default.
+
+#ifndef PRETTY_PRINT_INSTRUMENTATION
+#  define PRETTY_PRINT_INSTRUMENTATION 0
+#endif
+
+#if PRETTY_PRINT_INSTRUMENTATION
+#  include <chrono>
+#  include <cstdint>
+#  include <cstdlib>
+#  include <map>
+#  include <mutex>
+#  include <typeindex>
+#  include <typeinfo>
+#  include <vector>
+#  if defined(__has_include)
+#    if __has_include(<cxxabi.h>)
+#      include <cxxabi.h>
+#      define PRETTY_PRINT_HAS_CXXABI 1
+#    endif
+#  endif
+#endif
+
+namespace pretty_print
+{
+    namespace detail
+    {
+        // SFINAE type trait to detect whether T::const_iterator exists.
+
+        struct sfinae_base
+        {
+            using yes = char;
+            using no  = yes[2];
+        };
+
+        template <typename T>
+        struct has_const_iterator : private sfinae_base
+        {
+        private:
+            template <typename C> static yes & test(typename C::const_iterator*);
+            template <typename C> static no  & test(...);
+        public:
+            static const bool value = sizeof(test<T>(nullptr)) == sizeof(yes);
+            using type =  T;
+        };
+
+        template <typename T>
+        struct has_begin_end : private sfinae_base
+        {
+        private:
+            template <typename C>
+            static yes & f(typename std::enable_if<
+                std::is_same<decltype(static_cast<typename C::const_iterator(C::*)() const>(&C::begin)),
+                             typename C::const_iterator(C::*)() const>::value>::type *);
+
+            template <typename C> static no & f(...);
+
+            template <typename C>
+            static yes & g(typename std::enable_if<
+                std::is_same<decltype(static_cast<typename C::const_iterator(C::*)() const>(&C::end)),
+                             typename C::const_iterator(C::*)() const>::value, void>::type*);
+
+            template <typename C> static no & g(...);
+
+        public:
+            static bool const beg_value = sizeof(f<T>(nullptr)) == sizeof(yes);
+            static bool const end_value = sizeof(g<T>(nullptr)) == sizeof(yes);
+        };
+
+        // Detects C++20 ranges which lack the classic const_iterator interface, such as
+        // std::span and the lazy std::views adaptors. Views that can only be iterated
+        // when non-const are accepted, too; the printer iterates over a copy of those.
+
+#if PRETTY_PRINT_HAS_RANGES
+        template <typename T>
+        struct is_input_range : std::integral_constant<bool,
+            std::ranges::input_range<const T> ||
+            (std::ranges::view<T> && std::ranges::input_range<T> && std::copy_constructible<T>)> { };
+
+        template <typename T>
+        struct needs_view_copy : std::integral_constant<bool,
+            !std::ranges::input_range<const T> && std::ranges::view<T>> { };
+#else
+        template <typename T>
+        struct is_input_range : std::false_type { };
+
+        template <typename T>
+        struct needs_view_copy : std::false_type { };
+#endif
+
+        // A stream buffer which appends everything written to it to a string.
+
+        template <typename TChar, typename TCharTraits, typename TAllocator = std::allocator<TChar>>
+        struct appending_streambuf : std::basic_streambuf<TChar, TCharTraits>
+        {
+            using string_type = std::basic_string<TChar, TCharTraits, TAllocator>;
+            using int_type = typename TCharTraits::int_type;
+
+            explicit appending_streambuf(string_type & s) : m_s(&s) { }
+
+        protected:
+            int_type overflow(int_type c)
+            {
+                if (!TCharTraits::eq_int_type(c, TCharTraits::eof()))
+                    m_s->push_back(TCharTraits::to_char_type(c));
+                return TCharTraits::not_eof(c);
+            }
+
+            std::streamsize xsputn(const TChar * p, std::streamsize n)
+            {
+                m_s->append(p, static_cast<std::size_t>(n));
+                return n;
+            }
+
+        private:
+            string_type * m_s;
+        };
+
+        // Counts the elements printed at the current nesting level when instrumentation
+        // is enabled; compiles to nothing otherwise.
+
+#if PRETTY_PRINT_INSTRUMENTATION
+        inline std::uint64_t * & element_counter()
+        {
+            static thread_local std::uint64_t * counter = nullptr;
+            return counter;
+        }
+
+        inline void count_elements(std::uint64_t n)
+        {
+            if (std::uint64_t * c = element_counter()) *c += n;
+        }
+#else
+        inline void count_elements(std::size_t) { }
+#endif
+
+    }  // namespace detail
+
+
+    // Holds the delimiter values for a specific character type
+
+    template <typename TChar>
+    struct delimiters_values
+    {
+        using char_type = TChar;
+        const char_type * prefix;
+        const char_type * delimiter;
+        const char_type * postfix;
+    };
+
+
+    // Defines the delimiter values for a specific container and character type
+
+    template <typename T, typename TChar>
+    struct delimiters
+    {
+        using type = delimiters_values<TChar>;
+        static const type values; 
+    };
+
+
+    // Functor to print containers. You can use this directly if you want
+    // to specificy a non-default delimiters type. The printing logic can
+    // be customized by specializing the nested template.
+
+    template <typename T,
+              typename TChar = char,
+              typename TCharTraits = ::std::char_traits<TChar>,
+              typename TDelimiters = delimiters<T, TChar>>
+    struct print_container_helper
+    {
+        using delimiters_type = TDelimiters;
+        using ostream_type = std::basic_ostream<TChar, TCharTraits>;
+
+        template <typename U>
+        struct printer
+        {
+            static void print_body(const U & c, ostream_type & stream)
+            {
+#if PRETTY_PRINT_HAS_RANGES
+                if constexpr (detail::needs_view_copy<U>::value)
+                {
+                    U view(c);
+                    print_range(view, stream);
+                }
+                else
+#endif
+                {
+                    print_range(c, stream);
+                }
+            }
+
+            // The end may be a sentinel of a different type than the iterator,
+            // and each element is visited exactly once.
+
+            template <typename R>
+            static void print_range(R & c, ostream_type & stream)
+            {
+                using std::begin;
+                using std::end;
+
+                auto it = begin(c);
+                const auto the_end = end(c);
+
+                if (it != the_end)
+                {
+                    for ( ; ; )
+                    {
+                        stream << *it;
+                        detail::count_elements(1);
+
+                    if (++it == the_end) break;
+
+                    if (delimiters_type::values.delimiter != NULL)
+                        stream << delimiters_type::values.delimiter;
+                    }
+                }
+            }
+        };
+
+        print_container_helper(const T & container)
+        : container_(container)
+        { }
+
+        inline void operator()(ostream_type & stream) const
+        {
+            if (delimiters_type::values.prefix != NULL)
+                stream << delimiters_type::values.prefix;
+
+            printer<T>::print_body(container_, stream);
+
+            if (delimiters_type::values.postfix != NULL)
+                stream << delimiters_type::values.postfix;
+        }
+
+    private:
+        const T & container_;
+    };
+
+    // Specialization for pairs
+
+    template <typename T, typename TChar, typename TCharTraits, typename TDelimiters>
+    template <typename T1, typename T2>
+    struct print_container_helper<T, TChar, TCharTraits, TDelimiters>::printer<std::pair<T1, T2>>
+    {
+        using ostream_type = typename print_container_helper<T, TChar, TCharTraits, TDelimiters>::ostream_type;
+
+        static void print_body(const std::pair<T1, T2> & c, ostream_type & stream)
+        {
+            stream << c.first;
+            if (print_container_helper<T, TChar, TCharTraits, TDelimiters>::delimiters_type::values.delimiter != NULL)
+                stream << print_container_helper<T, TChar, TCharTraits, TDelimiters>::delimiters_type::values.delimiter;
+            stream << c.second;
+            detail::count_elements(2);
+        }
+    };
+
+#if PRETTY_PRINT_ATOMIC_RECORDS
+    // Per-stream switch for atomic record writes. While it is on, every top-level
+    // print is formatted into a thread-local buffer first and then handed to the
+    // stream buffer with a single sputn(), so that concurrent prints to a shared
+    // stream do not interleave and take the stream's lock only once per record.
+    // A stream shared between threads must not have a field width set while they
+    // print to it; the width applies to one print only and is reset by it, which
+    // would be a data race.
+    // Usage: std::cout << pretty_print::atomic_records;
+
+    inline int atomic_records_index()
+    {
+        static const int index = std::ios_base::xalloc();
+        return index;
+    }
+
+    template <typename TChar, typename TCharTraits>
+    inline std::basic_ostream<TChar, TCharTraits> & atomic_records(std::basic_ostream<TChar, TCharTraits> & stream)
+    {
+        stream.iword(atomic_records_index()) = 1;
+        return stream;
+    }
+
+    template <typename TChar, typename TCharTraits>
+    inline std::basic_ostream<TChar, TCharTraits> & no_atomic_records(std::basic_ostream<TChar, TCharTraits> & stream)
+    {
+        stream.iword(atomic_records_index()) = 0;
+        return stream;
+    }
+
+    // Policy for the per-thread scratch buffers used by buffered printing: a buffer
+    // keeps its capacity from print to print, but once it holds more than high_water
+    // characters, the first print which needed at most retain characters shrinks it
+    // back to a capacity of retain characters.
+
+    struct scratch_policy
+    {
+        std::size_t high_water;
+        std::size_t retain;
+    };
+
+    // Statistics of the calling thread's scratch buffer, in characters.
+
+    struct scratch_stats
+    {
+        std::size_t capacity;
+        std::size_t peak;
+        std::size_t shrinks;
+    };
+
+    namespace detail
+    {
+        inline std::atomic<std::size_t> & scratch_high_water()
+        {
+            static std::atomic<std::size_t> value(std::size_t(1) << 20);
+            return value;
+        }
+
+        inline std::atomic<std::size_t> & scratch_retain()
+        {
+            static std::atomic<std::size_t> value(std::size_t(64) << 10);
+            return value;
+        }
+
+        // A thread-local buffer and stream, reused across calls. While a record is
+        // being formatted, owner is the stream it is for. It outlives any caller's
+        // memory resource, so its text always comes from the global heap.
+
+        template <typename TChar, typename TCharTraits>
+        struct scratch_buffer
+        {
+            scratch_buffer() : buf(text), stream(&buf), owner(nullptr), peak(0), shrinks(0) { }
+
+            // Called after each use: records the high-water mark and applies the policy.
+
+            void release()
+            {
+                if (text.size() > peak) peak = text.size();
+
+                const std::size_t retain = scratch_retain().load(std::memory_order_relaxed);
+                if (text.capacity() > scratch_high_water().load(std::memory_order_relaxed) && text.size() <= retain)
+                {
+                    std::basic_string<TChar, TCharTraits> fresh;
+                    fresh.reserve(retain);
+                    text.swap(fresh);
+                    ++shrinks;
+                }
+                else
+                {
+                    text.clear();
+                }
+            }
+
+            std::basic_string<TChar, TCharTraits> text;
+            appending_streambuf<TChar, TCharTraits> buf;
+            std::basic_ostream<TChar, TCharTraits> stream;
+            const std::basic_ostream<TChar, TCharTraits> * owner;
+            std::size_t peak;
+            std::size_t shrinks;
+
+            static scratch_buffer & local()
+            {
+                static thread_local scratch_buffer b;
+                return b;
+            }
+        };
+
+    }  // namespace detail
+
+    inline void set_scratch_policy(const scratch_policy & policy)
+    {
+        detail::scratch_high_water().store(policy.high_water, std::memory_order_relaxed);
+        detail::scratch_retain().store(policy.retain, std::memory_order_relaxed);
+    }
+
+    inline scratch_policy get_scratch_policy()
+    {
+        scratch_policy policy = { detail::scratch_high_water().load(std::memory_order_relaxed),
+                                  detail::scratch_retain().load(std::memory_order_relaxed) };
+        return policy;
+    }
+
+    // Gives the calling thread's scratch buffer a capacity of at least n characters,
+    // so that records up to that size never allocate, not even the thread's first.
+    // A capacity above the high-water mark is given up again by the next small record.
+
+    template <typename TChar = char, typename TCharTraits = ::std::char_traits<TChar>>
+    inline void reserve_scratch(std::size_t n)
+    {
+        detail::scratch_buffer<TChar, TCharTraits>::local().text.reserve(n);
+    }
+
+    template <typename TChar = char, typename TCharTraits = ::std::char_traits<TChar>>
+    inline scratch_stats get_scratch_stats()
+    {
+        const detail::scratch_buffer<TChar, TCharTraits> & b = detail::scratch_buffer<TChar, TCharTraits>::local();
+        scratch_stats stats = { b.text.capacity(), b.peak, b.shrinks };
+        return stats;
+    }
+#endif
+
+#if PRETTY_PRINT_INSTRUMENTATION
+    // Statistics of one container type, summed over all threads. Times and sizes
+    // include those of nested containers; elements are counted per nesting level.
+
+    struct print_stats
+    {
+        print_stats() : calls(0), elements(0), bytes(0), nanoseconds(0) { }
+
+        std::string type;
+        std::uint64_t calls;
+        std::uint64_t elements;
+        std::uint64_t bytes;
+        std::uint64_t nanoseconds;
+    };
+
+    // Passed to the slow-print hook for a single print which exceeded the threshold.
+
+    struct slow_print_info
+    {
+        const char * type;
+        std::uint64_t elements;
+        std::uint64_t bytes;
+        std::uint64_t nanoseconds;
+    };
+
+    typedef void (*slow_print_hook)(const slow_print_info &);
+
+    namespace detail
+    {
+        inline std::string demangle(const char * name)
+        {
+#ifdef PRETTY_PRINT_HAS_CXXABI
+            int status = 0;
+            char * const p = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+            if (status == 0 && p != nullptr)
+            {
+                std::string result(p);
+                std::free(p);
+                return result;
+            }
+#endif
+            return name;
+        }
+
+        // One thread's counters for one container type. Only the owning thread
+        // writes, so relaxed loads and stores suffice. The registry links the shards
+        // through prev and next, so that registering one does not allocate.
+
+        struct stats_shard
+        {
+            explicit stats_shard(const std::type_info & t)
+            : type(t), calls(0), elements(0), bytes(0), nanoseconds(0), prev(nullptr), next(nullptr) { }
+
+            void add(std::atomic<std::uint64_t> & counter, std::uint64_t n)
+            {
+                counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+
+            const std::type_index type;
+            std::atomic<std::uint64_t> calls;
+            std::atomic<std::uint64_t> elements;
+            std::atomic<std::uint64_t> bytes;
+            std::atomic<std::uint64_t> nanoseconds;
+            stats_shard * prev;
+            stats_shard * next;
+        };
+
+        // The shards of running threads, and the sums of those of finished threads,
+        // into which a shard is merged when its thread exits.
+
+        struct stats_registry
+        {
+            std::mutex mutex;
+            stats_shard * shards = nullptr;
+            std::map<std::type_index, print_stats> retired;
+            std::atomic<std::uint64_t> threshold_ns { ~std::uint64_t(0) };
+            std::atomic<slow_print_hook> hook { nullptr };
+
+            static stats_registry & instance()
+            {
+                static stats_registry r;
+                return r;
+            }
+
+            void add(stats_shard * s)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                s->next = shards;
+                if (shards != nullptr) shards->prev = s;
+                shards = s;
+            }
+
+            void retire(stats_shard * s)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                merge(retired[s->type], *s);
+                (s->prev != nullptr ? s->prev->next : shards) = s->next;
+                if (s->next != nullptr) s->next->prev = s->prev;
+            }
+
+            static void merge(print_stats & t, const stats_shard & s)
+            {
+                t.calls += s.calls.load(std::memory_order_relaxed);
+                t.elements += s.elements.load(std::memory_order_relaxed);
+                t.bytes += s.bytes.load(std::memory_order_relaxed);
+                t.nanoseconds += s.nanoseconds.load(std::memory_order_relaxed);
+            }
+        };
+
+        template <typename T>
+        struct shard_owner
+        {
+            shard_owner() : shard(typeid(T)) { stats_registry::instance().add(&shard); }
+            ~shard_owner() { stats_registry::instance().retire(&shard); }
+
+            stats_shard shard;
+        };
+
+        template <typename T>
+        stats_shard & local_shard()
+        {
+            static thread_local shard_owner<T> owner;
+            return owner.shard;
+        }
+
+        // Forwards to another stream buffer and counts the characters, so that the
+        // output of a print can be measured without buffering all of it. The active
+        // one of the thread is the one that the outermost instrumented print created.
+
+        template <typename TChar, typename TCharTraits>
+        class counting_streambuf : public std::basic_streambuf<TChar, TCharTraits>
+        {
+        public:
+            using int_type = typename TCharTraits::int_type;
+
+            explicit counting_streambuf(std::basic_streambuf<TChar, TCharTraits> * target)
+            : m_target(target), m_flushed(0), m_failed(false)
+            {
+                this->setp(m_buf, m_buf + sizeof m_buf / sizeof m_buf[0]);
+            }
+
+            // Passes on what an interrupted print left in the buffer.
+
+            ~counting_streambuf()
+            {
+                flush_buffer();
+            }
+
+            std::uint64_t count() const
+            {
+                return m_flushed + static_cast<std::uint64_t>(this->pptr() - this->pbase());
+            }
+
+            // Passes on what is left in the local buffer; returns false if the target failed.
+
+            bool finish()
+            {
+                flush_buffer();
+                return !m_failed;
+            }
+
+            static counting_streambuf * & active()
+            {
+                static thread_local counting_streambuf * p = nullptr;
+                return p;
+            }
+
+        protected:
+            int_type overflow(int_type c)
+            {
+                if (!flush_buffer()) return TCharTraits::eof();
+                if (TCharTraits::eq_int_type(c, TCharTraits::eof())) return TCharTraits::not_eof(c);
+                *this->pptr() = TCharTraits::to_char_type(c);
+                this->pbump(1);
+                return c;
+            }
+
+            std::streamsize xsputn(const TChar * p, std::streamsize n)
+            {
+                if (!flush_buffer()) return 0;
+                const std::streamsize k = m_target->sputn(p, n);
+                m_flushed += static_cast<std::uint64_t>(k);
+                if (k != n) m_failed = true;
+                return k;
+            }
+
+        private:
+            bool flush_buffer()
+            {
+                const std::streamsize n = this->pptr() - this->pbase();
+                if (n != 0 && m_target->sputn(this->pbase(), n) != n) m_failed = true;
+                m_flushed += static_cast<std::uint64_t>(n);
+                this->setp(m_buf, m_buf + sizeof m_buf / sizeof m_buf[0]);
+                return !m_failed;
+            }
+
+            std::basic_streambuf<TChar, TCharTraits> * const m_target;
+            std::uint64_t m_flushed;
+            bool m_failed;
+            TChar m_buf[256];
+        };
+
+        // Points a thread-local pointer at a local for the lifetime of a scope, and
+        // restores it when the scope is left, also by an exception.
+
+        template <typename T>
+        struct scoped_pointer
+        {
+            scoped_pointer(T * & p, T * value) : m_p(p), m_old(p) { p = value; }
+            ~scoped_pointer() { m_p = m_old; }
+
+            scoped_pointer(const scoped_pointer &) = delete;
+            scoped_pointer & operator=(const scoped_pointer &) = delete;
+
+        private:
+            T * & m_p;
+            T * const m_old;
+        };
+
+        // Runs the helper and records the call, the elements it printed itself, the
+        // characters it printed and the elapsed time. The outermost print of a thread
+        // goes through a counting_streambuf in front of the stream's own buffer; the
+        // prints nested in it read the same counter.
+
+        template <typename T, typename THelper, typename TChar, typename TCharTraits>
+        void invoke_helper(const THelper & helper, std::basic_ostream<TChar, TCharTraits> & stream)
+        {
+            using counter_type = counting_streambuf<TChar, TCharTraits>;
+
+            std::uint64_t elements = 0;
+            std::uint64_t bytes = 0;
+            const auto start = std::chrono::steady_clock::now();
+
+            {
+                scoped_pointer<std::uint64_t> counting(element_counter(), &elements);
+
+                counter_type * const active = counter_type::active();
+                if (stream.rdbuf() == nullptr)
+                {
+                    helper(stream);
+                }
+                else if (active != nullptr && stream.rdbuf() == active)
+                {
+                    const std::uint64_t before = active->count();
+                    helper(stream);
+                    bytes = active->count() - before;
+                }
+                else
+                {
+                    if (stream.tie() != nullptr) stream.tie()->flush();
+
+                    counter_type counter(stream.rdbuf());
+                    std::basic_ostream<TChar, TCharTraits> counted(&counter);
+                    counted.flags(stream.flags());
+                    counted.precision(stream.precision());
+                    counted.fill(stream.fill());
+                    counted.width(stream.width());
+                    counted.imbue(stream.getloc());
+                    stream.width(0);
+
+                    {
+                        scoped_pointer<counter_type> activate(counter_type::active(), &counter);
+                        helper(counted);
+                    }
+
+                    bytes = counter.count();
+                    if (!counter.finish()) stream.setstate(std::ios_base::badbit);
+                    else if (!counted) stream.setstate(counted.rdstate());
+                    if (stream.flags() & std::ios_base::unitbuf) stream.flush();
+                }
+            }
+
+            const std::uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+            stats_shard & shard = local_shard<T>();
+            shard.add(shard.calls, 1);
+            shard.add(shard.elements, elements);
+            shard.add(shard.bytes, bytes);
+            shard.add(shard.nanoseconds, ns);
+
+            stats_registry & registry = stats_registry::instance();
+            if (ns > registry.threshold_ns.load(std::memory_order_relaxed))
+            {
+                if (slow_print_hook hook = registry.hook.load(std::memory_order_relaxed))
+                {
+                    const std::string type = demangle(typeid(T).name());
+                    const slow_print_info info = { type.c_str(), elements, bytes, ns };
+                    hook(info);
+                }
+            }
+        }
+
+    }  // namespace detail
+
+    // Sums the per-thread counters, including those of finished threads; one entry
+    // per printed container type.
+
+    inline std::vector<print_stats> collect_print_stats()
+    {
+        detail::stats_registry & registry = detail::stats_registry::instance();
+        std::map<std::type_index, print_stats> totals;
+
+        {
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            totals = registry.retired;
+            for (const detail::stats_shard * s = registry.shards; s != nullptr; s = s->next)
+                detail::stats_registry::merge(totals[s->type], *s);
+        }
+
+        std::vector<print_stats> result;
+        for (auto & t : totals)
+        {
+            t.second.type = detail::demangle(t.first.name());
+            result.push_back(t.second);
+        }
+        return result;
+    }
+
+    // Installs a hook which is called for every print taking longer than threshold.
+
+    inline void set_slow_print_hook(std::chrono::nanoseconds threshold, slow_print_hook hook)
+    {
+        detail::stats_registry & registry = detail::stats_registry::instance();
+        registry.threshold_ns.store(static_cast<std::uint64_t>(threshold.count()), std::memory_order_relaxed);
+        registry.hook.store(hook, std::memory_order_relaxed);
+    }
+#else
+    namespace detail
+    {
+        template <typename T, typename THelper, typename TStream>
+        inline void invoke_helper(const THelper & helper, TStream & stream)
+        {
+            helper(stream);
+        }
+    }
+#endif
+
+#if PRETTY_PRINT_ATOMIC_RECORDS
+    namespace detail
+    {
+        // The buffered path of operator<<. It only depends on the character type and
+        // is kept out of line, so that each container's operator<< merely makes a call.
+        // begin_record returns the stream to print to: the stream itself, the record's
+        // buffer, or null if the stream is not good. The stream's own state is only
+        // read, apart from a non-zero width, which the print consumes.
+
+        template <typename TChar, typename TCharTraits>
+        PRETTY_PRINT_NOINLINE std::basic_ostream<TChar, TCharTraits> * begin_record(std::basic_ostream<TChar, TCharTraits> & stream)
+        {
+            if (stream.iword(atomic_records_index()) == 0) return &stream;
+
+            scratch_buffer<TChar, TCharTraits> & record = scratch_buffer<TChar, TCharTraits>::local();
+            if (&stream == &record.stream) return &stream;
+            if (record.owner != nullptr && record.owner != &stream) return &stream;
+            if (!stream.good()) return nullptr;
+
+            record.owner = &stream;
+            record.text.clear();
+            record.stream.clear();
+            record.stream.flags(stream.flags());
+            record.stream.precision(stream.precision());
+            record.stream.fill(stream.fill());
+            record.stream.width(stream.width());
+            if (record.stream.getloc() != stream.getloc()) record.stream.imbue(stream.getloc());
+            if (stream.width() != 0) stream.width(0);
+
+            return &record.stream;
+        }
+
+        template <typename TChar, typename TCharTraits>
+        PRETTY_PRINT_NOINLINE void end_record(std::basic_ostream<TChar, TCharTraits> & stream)
+        {
+            scratch_buffer<TChar, TCharTraits> & record = scratch_buffer<TChar, TCharTraits>::local();
+            bool failed = false;
+
+            {
+                typename std::basic_ostream<TChar, TCharTraits>::sentry ok(stream);
+                const std::streamsize n = static_cast<std::streamsize>(record.text.size());
+                failed = ok && stream.rdbuf()->sputn(record.text.data(), n) != n;
+            }
+
+            const std::ios_base::iostate state = record.stream.rdstate();
+            record.owner = nullptr;
+            record.release();
+
+            if (failed) stream.setstate(std::ios_base::badbit);
+            else if (state != std::ios_base::goodbit) stream.setstate(state);
+        }
+
+        // Drops the record of a print which an exception interrupted.
+
+        template <typename TChar, typename TCharTraits>
+        PRETTY_PRINT_NOINLINE void abandon_record()
+        {
+            scratch_buffer<TChar, TCharTraits> & record = scratch_buffer<TChar, TCharTraits>::local();
+            record.owner = nullptr;
+            record.text.clear();
+        }
+
+        template <typename TChar, typename TCharTraits>
+        struct record_guard
+        {
+            explicit record_guard(bool active) : active(active) { }
+            ~record_guard() { if (active) abandon_record<TChar, TCharTraits>(); }
+
+            bool active;
+        };
+
+    }  // namespace detail
+
+    // Prints a print_container_helper to the specified stream.
+
+    template<typename T, typename TChar, typename TCharTraits, typename TDelimiters>
+    inline std::basic_ostream<TChar, TCharTraits> & operator<<(
+        std::basic_ostream<TChar, TCharTraits> & stream,
+        const print_container_helper<T, TChar, TCharTraits, TDelimiters> & helper)
+    {
+        if (std::basic_ostream<TChar, TCharTraits> * target = detail::begin_record(stream))
+        {
+            detail::record_guard<TChar, TCharTraits> guard(target != &stream);
+            detail::invoke_helper<T>(helper, *target);
+            if (guard.active)
+            {
+                guard.active = false;
+                detail::end_record(stream);
+            }
+        }
+
+        return stream;
+    }
+#else
+    // Prints a print_container_helper to the specified stream.
+
+    template<typename T, typename TChar, typename TCharTraits, typename TDelimiters>
+    inline std::basic_ostream<TChar, TCharTraits> & operator<<(
+        std::basic_ostream<TChar, TCharTraits> & stream,
+        const print_container_helper<T, TChar, TCharTraits, TDelimiters> & helper)
+    {
+        detail::invoke_helper<T>(helper, stream);
+        return stream;
+    }
+#endif
+
+
+    // Basic is_container template; specialize to derive from std::true_type for all desired container types
+
+    template <typename T>
+    struct is_container : public std::integral_constant<bool,
+                                                        (detail::has_const_iterator<T>::value &&
+                                                         detail::has_begin_end<T>::beg_value  &&
+                                                         detail::has_begin_end<T>::end_value) ||
+                                                        detail::is_input_range<T>::value> { };
+
+    template <typename T, std::size_t N>
+    struct is_container<T[N]> : std::true_type { };
+
+    template <std::size_t N>
+    struct is_container<char[N]> : std::false_type { };
+
+    template <typename T1, typename T2>
+    struct is_container<std::pair<T1, T2>> : std::true_type { };
+
+
+
+    // Default delimiters
+
+    template <typename T> struct delimiters<T, char> { static const delimiters_values<char> values; };
+    template <typename T> const delimiters_values<char> delimiters<T, char>::values = { "[", ", ", "]" };
+    template <typename T> struct delimiters<T, wchar_t> { static const delimiters_values<wchar_t> values; };
+    template <typename T> const delimiters_values<wchar_t> delimiters<T, wchar_t>::values = { L"[", L", ", L"]" };
+
+
+    // Delimiters for pair
+
+    template <typename T1, typename T2> struct delimiters<std::pair<T1, T2>, char> { static const delimiters_values<char> values; };
+    template <typename T1, typename T2> const delimiters_values<char> delimiters<std::pair<T1, T2>, char>::values = { "(", ", ", ")" };
+    template <typename T1, typename T2> struct delimiters< ::std::pair<T1, T2>, wchar_t> { static const delimiters_values<wchar_t> values; };
+    template <typename T1, typename T2> const delimiters_values<wchar_t> delimiters< ::std::pair<T1, T2>, wchar_t>::values = { L"(", L", ", L")" };
+
+
+    // Type-erasing helper class for easy use of custom delimiters.
+    // Requires TCharTraits = std::char_traits<TChar> and TChar = char or wchar_t, and MyDelims needs to be defined for TChar.
+    // Usage: "cout << pretty_print::custom_delims<MyDelims>(x)".
+
+    struct custom_delims_base
+    {
+        virtual ~custom_delims_base() { }
+        virtual std::ostream & stream(::std::ostream &) = 0;
+        virtual std::wostream & stream(::std::wostream &) = 0;
+        virtual custom_delims_base * copy_to(void * where) const = 0;
+    };
+
+    template <typename T, typename Delims>
+    struct custom_delims_wrapper : custom_delims_base
+    {
+        custom_delims_wrapper(const T & t_) : t(t_) { }
+
+        custom_delims_base * copy_to(void * where) const
+        {
+            return ::new (where) custom_delims_wrapper(*this);
+        }
+
+        std::ostream & stream(std::ostream & s)
+        {
+            return s << print_container_helper<T, char, std::char_traits<char>, Delims>(t);
+        }
+
+        std::wostream & stream(std::wostream & s)
+        {
+            return s << print_container_helper<T, wchar_t, std::char_traits<wchar_t>, Delims>(t);
+        }
+
+    private:
+        const T & t;
+    };
+
+    // The wrapper only holds a reference, so its size does not depend on the container
+    // type and it is kept in place; custom_delims never allocates.
+
+    template <typename Delims>
+    struct custom_delims
+    {
+        template <typename Container>
+        custom_delims(const Container & c) : base(::new (storage) custom_delims_wrapper<Container, Delims>(c))
+        {
+            static_assert(sizeof(custom_delims_wrapper<Container, Delims>) <= sizeof(storage),
+                          "custom_delims_wrapper does not fit into custom_delims::storage");
+        }
+
+        custom_delims(const custom_delims & other) : base(other.base->copy_to(storage)) { }
+
+        custom_delims & operator=(const custom_delims & other)
+        {
+            if (this != &other)
+            {
+                base->~custom_delims_base();
+                base = other.base->copy_to(storage);
+            }
+            return *this;
+        }
+
+        ~custom_delims() { base->~custom_delims_base(); }
+
+        alignas(custom_delims_wrapper<int, Delims>) unsigned char storage[sizeof(custom_delims_wrapper<int, Delims>)];
+        custom_delims_base * base;
+    };
+
+    template <typename TChar, typename TCharTraits, typename Delims>
+    inline std::basic_ostream<TChar, TCharTraits> & operator<<(std::basic_ostream<TChar, TCharTraits> & s, const custom_delims<Delims> & p)
+    {
+        return p.base->stream(s);
+    }
+
+}   // namespace pretty_print
+
+
+// Main magic entry point: An overload snuck into namespace std.
+// Can we do better?
+
+namespace std
+{
+    // Prints a container to the stream using default delimiters
+
+    template<typename T, typename TChar, typename TCharTraits>
+    inline typename enable_if< ::pretty_print::is_container<T>::value,
+                              basic_ostream<TChar, TCharTraits> &>::type
+    operator<<(basic_ostream<TChar, TCharTraits> & stream, const T & container)
+    {
+        return stream << ::pretty_print::print_container_helper<T, TChar, TCharTraits>(container);
+    }
+}
+
+
+
+#endif  // H_PRETTY_PRINT_CORE
@@ -0,0 +1,340 @@
+//          Copyright Louis Delacroix 2010 - 2014.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+// Reproducible test data for benchmarking the printers.
+//
+// Usage:
+// pretty_print::dataset::shape s;
+// s.sizes = { dataset::distribution::fixed(1000), dataset::distribution::skewed(0, 100, 3) };
+// s.digits = dataset::distribution::uniform(1, 3);
+// auto v = dataset::make<std::vector<std::vector<int>>>(seed, s);
+//
+// The same seed and shape give the same data with every compiler and standard
+// library: only std::mt19937, whose output sequence is fixed by the standard, is
+// used, and never the implementation-defined std:: distributions. All scaling is
+// done in integer arithmetic, or for doubles by exact powers of ten, whose single
+// multiplication or division IEEE 754 rounds the same everywhere.
+
+#ifndef H_PRETTY_PRINT_DATASET
+#define H_PRETTY_PRINT_DATASET
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <valarray>
+#include <vector>
+
+namespace pretty_print
+{
+namespace dataset
+{
+    typedef std::mt19937 rng_type;
+
+    // Uniform integer in [lo, hi]. The modulo bias is negligible for the small
+    // ranges used here and keeps the sequence simple to reproduce.
+
+    inline std::uint64_t uniform_int(rng_type & rng, std::uint64_t lo, std::uint64_t hi)
+    {
+        const std::uint64_t r = (std::uint64_t(rng()) << 32) | rng();
+        const std::uint64_t span = hi - lo + 1;
+        return span == 0 ? r : lo + r % span;
+    }
+
+    // Uniform real in [0, 1).
+
+    inline double uniform_real(rng_type & rng)
+    {
+        return double(rng() >> 5) * (1.0 / 134217728.0);
+    }
+
+    // A distribution of non-negative integers, used for container sizes, string
+    // lengths and digit counts. Skewed draws lo + (hi - lo + 1) * u^power, so a
+    // power above 1 makes most values small and a few close to hi; u^power is
+    // computed in 32-bit fixed point.
+
+    class distribution
+    {
+    public:
+        static distribution fixed(std::size_t n) { return distribution(n, n, 1); }
+        static distribution uniform(std::size_t lo, std::size_t hi) { return distribution(lo, hi, 1); }
+        static distribution skewed(std::size_t lo, std::size_t hi, unsigned power) { return distribution(lo, hi, power); }
+
+        std::size_t operator()(rng_type & rng) const
+        {
+            if (m_lo == m_hi) return m_lo;
+            if (m_power <= 1) return std::size_t(uniform_int(rng, m_lo, m_hi));
+
+            const std::uint64_t u = rng();
+            std::uint64_t x = u;
+            for (unsigned i = 1; i != m_power; ++i) x = (x * u) >> 32;
+
+            const std::uint64_t span = std::uint64_t(m_hi - m_lo) + 1;
+            return m_lo + std::size_t((span >> 32) * x + (((span & 0xffffffffu) * x) >> 32));
+        }
+
+    private:
+        distribution(std::size_t lo, std::size_t hi, unsigned power) : m_lo(lo), m_hi(hi), m_power(power) { }
+
+        std::size_t m_lo;
+        std::size_t m_hi;
+        unsigned m_power;
+    };
+
+    // What to generate. Container sizes are drawn from sizes[depth], where depth
+    // is the nesting level of the container; the last entry applies to all deeper
+    // levels. Integers have a number of decimal digits drawn from digits.
+
+    struct shape
+    {
+        shape()
+        : sizes(1, distribution::uniform(0, 5))
+        , digits(distribution::uniform(1, 6))
+        , string_length(distribution::uniform(0, 7))
+        , negative(0.5)
+        { }
+
+        std::vector<distribution> sizes;
+        distribution digits;
+        distribution string_length;
+        double negative;    // probability of a negative number
+
+        std::size_t size(rng_type & rng, std::size_t depth) const
+        {
+            return sizes[depth < sizes.size() ? depth : sizes.size() - 1](rng);
+        }
+    };
+
+    // generator<T>::make(rng, shape, depth) creates one value of type T.
+    // Specialize it to add types.
+
+    template <typename T, typename Enable = void> struct generator;
+
+    template <typename T>
+    struct generator<T, typename std::enable_if<std::is_integral<T>::value && sizeof(T) != 1>::type>
+    {
+        static T make(rng_type & rng, const shape & s, std::size_t)
+        {
+            const unsigned max_digits = std::numeric_limits<T>::digits10;
+            std::size_t d = s.digits(rng);
+            d = d == 0 ? 1 : d > max_digits ? max_digits : d;
+
+            std::uint64_t lo = 1;
+            for (std::size_t i = 1; i != d; ++i) lo *= 10;
+            const std::uint64_t value = d == 1 ? uniform_int(rng, 0, 9) : uniform_int(rng, lo, lo * 10 - 1);
+
+            const bool negative = std::is_signed<T>::value && uniform_real(rng) < s.negative;
+            return negative ? T(-T(value)) : T(value);
+        }
+    };
+
+    template <typename T>
+    struct generator<T, typename std::enable_if<std::is_integral<T>::value && sizeof(T) == 1>::type>
+    {
+        static T make(rng_type & rng, const shape &, std::size_t)
+        {
+            return T('a' + uniform_int(rng, 0, 25));
+        }
+    };
+
+    template <>
+    struct generator<wchar_t>
+    {
+        static wchar_t make(rng_type & rng, const shape &, std::size_t)
+        {
+            return wchar_t(L'a' + uniform_int(rng, 0, 25));
+        }
+    };
+
+    template <>
+    struct generator<bool>
+    {
+        static bool make(rng_type & rng, const shape &, std::size_t)
+        {
+            return (rng() >> 31) != 0;
+        }
+    };
+
+    // Doubles get digits significant digits and a random decimal exponent in [-3, 6].
+    // The mantissa has at most 15 digits, so it and the powers of ten are exact.
+
+    template <>
+    struct generator<double>
+    {
+        static double make(rng_type & rng, const shape & s, std::size_t depth)
+        {
+            static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6 };
+
+            const double mantissa = double(generator<long long>::make(rng, s, depth));
+            const int exponent = int(uniform_int(rng, 0, 9)) - 3;
+            return exponent < 0 ? mantissa / powers[-exponent] : mantissa * powers[exponent];
+        }
+    };
+
+    template <typename TChar, typename TTraits, typename TAllocator>
+    struct generator<std::basic_string<TChar, TTraits, TAllocator>>
+    {
+        static std::basic_string<TChar, TTraits, TAllocator> make(rng_type & rng, const shape & s, std::size_t depth)
+        {
+            std::basic_string<TChar, TTraits, TAllocator> str(s.string_length(rng), TChar());
+            for (auto & c : str) c = generator<TChar>::make(rng, s, depth);
+            return str;
+        }
+    };
+
+    template <typename T1, typename T2>
+    struct generator<std::pair<T1, T2>>
+    {
+        static std::pair<T1, T2> make(rng_type & rng, const shape & s, std::size_t depth)
+        {
+            T1 first = generator<T1>::make(rng, s, depth);
+            return std::pair<T1, T2>(std::move(first), generator<T2>::make(rng, s, depth));
+        }
+    };
+
+    template <typename ...Args>
+    struct generator<std::tuple<Args...>>
+    {
+        // Braced initialization evaluates the elements from left to right.
+        static std::tuple<Args...> make(rng_type & rng, const shape & s, std::size_t depth)
+        {
+            return std::tuple<Args...> { generator<Args>::make(rng, s, depth)... };
+        }
+    };
+
+    template <typename T, typename TAllocator>
+    struct generator<std::vector<T, TAllocator>>
+    {
+        static std::vector<T, TAllocator> make(rng_type & rng, const shape & s, std::size_t depth)
+        {
+            const std::size_t n = s.size(rng, depth);
+            std::vector<T, TAllocator> v;
+            v.reserve(n);
+            for (std::size_t i = 0; i != n; ++i) v.push_back(generator<T>::make(rng, s, depth + 1));
+            return v;
+        }
+    };
+
+    template <typename T>
+    struct generator<std::valarray<T>>
+    {
+        static std::valarray<T> make(rng_type & rng, const shape & s, std::size_t depth)
+        {
+            std::valarray<T> v(s.size(rng, depth));
+            for (auto & x : v) x = generator<T>::make(rng, s, depth + 1);
+            return v;
+        }
+    };
+
+    // Sets and maps get the drawn number of insertions; duplicates make them smaller.
+
+    template <typename T, typename TComp, typename TAllocator>
+    struct generator<std::set<T, TComp, TAllocator>>
+    {
+        static std::set<T, TComp, TAllocator> make(rng_type & rng, const shape & s, std::size_t depth)
+        {
+            std::set<T, TComp, TAllocator> c;
+            for (std::size_t n = s.size(rng, depth); n != 0; --n) c.insert(generator<T>::make(rng, s, depth + 1));
+            return c;
+        }
+    };
+
+    template <typename K, typename V, typename TComp, typename TAllocator>
+    struct generator<std::map<K, V, TComp, TAllocator>>
+    {
+        static std::map<K, V, TComp, TAllocator> make(rng_type & rng, const shape & s, std::size_t depth)
+        {
+            std::map<K, V, TComp, TAllocator> c;
+            for (std::size_t n = s.size(rng, depth); n != 0; --n) c.insert(generator<std::pair<K, V>>::make(rng, s, depth + 1));
+            return c;
+        }
+    };
+
+    template <typename K, typename V, typename THash, typename TPred, typename TAllocator>
+    struct generator<std::unordered_map<K, V, THash, TPred, TAllocator>>
+    {
+        static std::unordered_map<K, V, THash, TPred, TAllocator> make(rng_type & rng, const shape & s, std::size_t depth)
+        {
+            std::unordered_map<K, V, THash, TPred, TAllocator> c;
+            for (std::size_t n = s.size(rng, depth); n != 0; --n) c.insert(generator<std::pair<K, V>>::make(rng, s, depth + 1));
+            return c;
+        }
+    };
+
+    template <typename T>
+    T make(rng_type & rng, const shape & s = shape())
+    {
+        return generator<T>::make(rng, s, 0);
+    }
+
+    template <typename T>
+    T make(std::uint32_t seed, const shape & s = shape())
+    {
+        rng_type rng(seed);
+        return generator<T>::make(rng, s, 0);
+    }
+
+    // Named datasets of count top-level elements, shared by the benchmarks and the
+    // ppdataset tool. visit(name, count, seed, f) calls f(value) and returns false
+    // for an unknown name.
+
+    struct catalogue_entry
+    {
+        const char * name;
+        const char * description;
+    };
+
+    static const catalogue_entry catalogue[] =
+    {
+        { "ints-short", "vector<int>, 1 to 3 digits" },
+        { "ints-long", "vector<int>, 7 to 9 digits" },
+        { "ints-skewed", "vector<int>, mostly short, some up to 9 digits" },
+        { "doubles", "vector<double>, 1 to 15 significant digits" },
+        { "strings-short", "vector<string>, 0 to 8 characters" },
+        { "strings-long", "vector<string>, 64 to 256 characters" },
+        { "map-int-string", "map<int, string>" },
+        { "map-string-int", "map<string, int>, 4 to 16 character keys" },
+        { "nested-skewed", "vector<vector<int>>, inner sizes 0 to 1000, mostly small" },
+        { "tuples", "vector<tuple<int, string, double>>" },
+    };
+
+    template <typename F>
+    bool visit(const std::string & name, std::size_t count, std::uint32_t seed, F & f)
+    {
+        const std::size_t n = sizeof catalogue / sizeof catalogue[0];
+        std::size_t i = 0;
+        while (i != n && name != catalogue[i].name) ++i;
+
+        shape s;
+        s.sizes.assign(1, distribution::fixed(count));
+
+        switch (i)
+        {
+        case 0: s.digits = distribution::uniform(1, 3); f(make<std::vector<int>>(seed, s)); break;
+        case 1: s.digits = distribution::uniform(7, 9); f(make<std::vector<int>>(seed, s)); break;
+        case 2: s.digits = distribution::skewed(1, 9, 3); f(make<std::vector<int>>(seed, s)); break;
+        case 3: s.digits = distribution::uniform(1, 15); f(make<std::vector<double>>(seed, s)); break;
+        case 4: s.string_length = distribution::uniform(0, 8); f(make<std::vector<std::string>>(seed, s)); break;
+        case 5: s.string_length = distribution::uniform(64, 256); f(make<std::vector<std::string>>(seed, s)); break;
+        case 6: f(make<std::map<int, std::string>>(seed, s)); break;
+        case 7: s.digits = distribution::uniform(1, 9); s.string_length = distribution::uniform(4, 16); f(make<std::map<std::string, int>>(seed, s)); break;
+        case 8: s.sizes.push_back(distribution::skewed(0, 1000, 4)); f(make<std::vector<std::vector<int>>>(seed, s)); break;
+        case 9: f(make<std::vector<std::tuple<int, std::string, double>>>(seed, s)); break;
+        default: return false;
+        }
+        return true;
+    }
+
+}   // namespace dataset
+}   // namespace pretty_print
+
+#endif  // H_PRETTY_PRINT_DATASET
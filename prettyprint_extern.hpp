@@ -0,0 +1,40 @@
+//          Copyright Louis Delacroix 2010 - 2014.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+// Extern template declarations for the printers of common container types, so
+// that they are compiled once, in prettyprint_instances.cpp, instead of in every
+// translation unit. The types are listed in prettyprint_instances.def.
+//
+// Usage:
+// Compile prettyprint_instances.cpp into a library, and compile its users with
+// -DPRETTY_PRINT_EXTERN_TEMPLATES, which makes prettyprint.hpp include this file.
+
+#ifndef H_PRETTY_PRINT_EXTERN
+#define H_PRETTY_PRINT_EXTERN
+
+#include "prettyprint.hpp"
+
+#ifndef PRETTY_PRINT_INSTANCE_LIST
+#  define PRETTY_PRINT_INSTANCE_LIST "prettyprint_instances.def"
+#endif
+
+// Everything "stream << x" instantiates for a container x of type T: the helper,
+// its printer for T, the buffering operator<< and the entry point in namespace std.
+
+#define PRETTY_PRINT_INSTANTIATE(Extern, TChar, ...)                                                  \
+    Extern template struct pretty_print::print_container_helper<__VA_ARGS__, TChar>;                 \
+    Extern template struct pretty_print::print_container_helper<__VA_ARGS__, TChar>::printer<__VA_ARGS__>; \
+    Extern template std::basic_ostream<TChar> & pretty_print::operator<<(                           \
+        std::basic_ostream<TChar> &, const pretty_print::print_container_helper<__VA_ARGS__, TChar> &); \
+    Extern template std::basic_ostream<TChar> & std::operator<< <__VA_ARGS__, TChar, std::char_traits<TChar>>( \
+        std::basic_ostream<TChar> &, const __VA_ARGS__ &);
+
+#ifndef PRETTY_PRINT_DEFINE_INSTANCES
+#  define PRETTY_PRINT_INSTANCE(TChar, ...) PRETTY_PRINT_INSTANTIATE(extern, TChar, __VA_ARGS__)
+#  include PRETTY_PRINT_INSTANCE_LIST
+#  undef PRETTY_PRINT_INSTANCE
+#endif
+
+#endif  // H_PRETTY_PRINT_EXTERN
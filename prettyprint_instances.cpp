@@ -0,0 +1,13 @@
+/* The explicit instantiations declared by prettyprint_extern.hpp. Build this file
+   into a static library with the same PRETTY_PRINT_INSTANCE_LIST and the same
+   configuration macros as its users, e.g.
+     g++ -O2 -std=c++0x -c prettyprint_instances.cpp && ar rcs libprettyprint.a prettyprint_instances.o
+*/
+
+#define PRETTY_PRINT_DEFINE_INSTANCES
+
+#include "prettyprint_extern.hpp"
+
+#define PRETTY_PRINT_INSTANCE(TChar, ...) PRETTY_PRINT_INSTANTIATE(, TChar, __VA_ARGS__)
+#include PRETTY_PRINT_INSTANCE_LIST
+#undef PRETTY_PRINT_INSTANCE
@@ -0,0 +1,816 @@
+//          Copyright Louis Delacroix 2010 - 2014.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+// Output sinks for large or frequent container dumps.
+//
+// Usage:
+// Attach one of the stream buffers below to a std::ostream and print to it
+// as usual. POSIX only.
+
+#ifndef H_PRETTY_PRINT_SINKS
+#define H_PRETTY_PRINT_SINKS
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace pretty_print
+{
+    // A file stream buffer which overlaps formatting with I/O. The printer fills
+    // one buffer while a dedicated thread writes the other one to the file, and
+    // the two buffers are reused for the lifetime of the object. In direct mode
+    // the file is opened with O_DIRECT (where available), the buffers are aligned
+    // to direct_alignment and only whole blocks are written until the file is closed.
+    // The buffer size is rounded up to 1, or to a multiple of direct_alignment in direct mode.
+    // Usage: pretty_print::pipelined_filebuf buf("dump.txt"); std::ostream os(&buf); os << x;
+
+    class pipelined_filebuf : public std::streambuf
+    {
+    public:
+        static const std::size_t default_buffer_size = std::size_t(4) << 20;
+        static const std::size_t direct_alignment = 4096;
+
+        explicit pipelined_filebuf(const char * path,
+                                   std::size_t buffer_size = default_buffer_size,
+                                   bool direct = false)
+        : m_fd(-1), m_size(buffer_size), m_direct(direct), m_cur(0),
+          m_pending(nullptr), m_pending_len(0), m_stop(false), m_error(false)
+        {
+            // A buffer holds at least one character, and in direct mode whole blocks.
+
+            if (m_size == 0)
+                m_size = 1;
+            if (m_direct)
+                m_size = (m_size + direct_alignment - 1) / direct_alignment * direct_alignment;
+
+            int flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef O_DIRECT
+            if (m_direct) flags |= O_DIRECT;
+#endif
+            m_fd = ::open(path, flags, 0644);
+#ifdef O_DIRECT
+            // Some file systems reject O_DIRECT; the aligned block writes are kept regardless.
+            if (m_fd < 0 && m_direct && errno == EINVAL)
+                m_fd = ::open(path, flags & ~O_DIRECT, 0644);
+#endif
+            if (m_fd < 0) return;
+
+            for (char * & b : m_buf)
+            {
+                void * p = nullptr;
+                if (::posix_memalign(&p, direct_alignment, m_size) != 0)
+                {
+                    close_file();
+                    return;
+                }
+                b = static_cast<char *>(p);
+            }
+
+            setp(m_buf[0], m_buf[0] + m_size);
+            m_io = std::thread(&pipelined_filebuf::io_loop, this);
+        }
+
+        pipelined_filebuf(const pipelined_filebuf &) = delete;
+        pipelined_filebuf & operator=(const pipelined_filebuf &) = delete;
+
+        ~pipelined_filebuf()
+        {
+            close();
+            for (char * b : m_buf) std::free(b);
+        }
+
+        bool is_open() const
+        {
+            return m_fd >= 0;
+        }
+
+        // Writes out everything and closes the file; returns false if any write failed.
+
+        bool close()
+        {
+            if (!is_open()) return false;
+
+            hand_off(pptr() - pbase(), true);
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_cv.notify_all();
+            m_io.join();
+
+            // The unaligned tail cannot be written in direct mode.
+            const std::size_t tail = pptr() - pbase();
+            if (tail != 0)
+            {
+#ifdef O_DIRECT
+                if (m_direct) ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) & ~O_DIRECT);
+#endif
+                if (!write_fully(pbase(), tail)) m_error = true;
+            }
+
+            setp(nullptr, nullptr);
+            close_file();
+            return !m_error;
+        }
+
+    protected:
+        int_type overflow(int_type c)
+        {
+            if (!is_open() || !hand_off(pptr() - pbase(), false)) return traits_type::eof();
+
+            if (!traits_type::eq_int_type(c, traits_type::eof()))
+            {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        int sync()
+        {
+            if (!is_open()) return -1;
+
+            return hand_off(pptr() - pbase(), true) ? 0 : -1;
+        }
+
+    private:
+        // Passes the first len characters of the current buffer to the I/O thread and
+        // continues in the other buffer. In direct mode only whole blocks are passed on
+        // and the remainder is carried over. With wait, returns only once the I/O is done.
+        // Returns false if a write has failed.
+
+        bool hand_off(std::size_t len, bool wait)
+        {
+            const std::size_t n = m_direct ? len / direct_alignment * direct_alignment : len;
+            char * const full = m_buf[m_cur];
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_pending == nullptr; });
+
+            m_cur = 1 - m_cur;
+            std::memcpy(m_buf[m_cur], full + n, len - n);
+            setp(m_buf[m_cur], m_buf[m_cur] + m_size);
+            pbump(static_cast<int>(len - n));
+
+            if (n != 0)
+            {
+                m_pending = full;
+                m_pending_len = n;
+                m_cv.notify_all();
+            }
+
+            if (wait)
+                m_cv.wait(lock, [this] { return m_pending == nullptr; });
+
+            return !m_error;
+        }
+
+        void io_loop()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            for ( ; ; )
+            {
+                m_cv.wait(lock, [this] { return m_pending != nullptr || m_stop; });
+                if (m_pending == nullptr) return;
+
+                const char * const p = m_pending;
+                const std::size_t n = m_pending_len;
+
+                lock.unlock();
+                const bool ok = write_fully(p, n);
+                lock.lock();
+
+                if (!ok) m_error = true;
+                m_pending = nullptr;
+                m_cv.notify_all();
+            }
+        }
+
+        bool write_fully(const char * p, std::size_t n)
+        {
+            while (n != 0)
+            {
+                const ::ssize_t k = ::write(m_fd, p, n);
+                if (k < 0)
+                {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                p += k;
+                n -= static_cast<std::size_t>(k);
+            }
+            return true;
+        }
+
+        void close_file()
+        {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+
+        int m_fd;
+        std::size_t m_size;
+        const bool m_direct;
+        char * m_buf[2] = { nullptr, nullptr };
+        int m_cur;
+
+        std::thread m_io;
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        const char * m_pending;
+        std::size_t m_pending_len;
+        bool m_stop;
+        bool m_error;
+    };
+
+
+
+    namespace detail
+    {
+        // A stream buffer over a fixed array of atomic characters, which silently drops
+        // whatever does not fit and remembers that it did. Output is collected in a
+        // small local buffer and stored with relaxed atomic stores, so that readers may
+        // copy the array concurrently without a data race.
+
+        struct atomic_slot_streambuf : std::streambuf
+        {
+            atomic_slot_streambuf(std::atomic<char> * p, std::size_t n)
+            : m_p(p), m_capacity(n), m_size(0), m_truncated(false)
+            {
+                setp(m_buf, m_buf + sizeof m_buf);
+            }
+
+            std::size_t size() const { return m_size; }
+            bool truncated() const { return m_truncated; }
+
+            // Stores what is left in the local buffer; call once after formatting.
+            void finish() { store(); }
+
+        protected:
+            int_type overflow(int_type c)
+            {
+                store();
+                if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+                if (m_size == m_capacity)
+                {
+                    m_truncated = true;
+                    return traits_type::eof();
+                }
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+                return c;
+            }
+
+        private:
+            void store()
+            {
+                const std::size_t n = static_cast<std::size_t>(pptr() - pbase());
+                const std::size_t k = n < m_capacity - m_size ? n : m_capacity - m_size;
+                for (std::size_t i = 0; i != k; ++i) m_p[m_size + i].store(m_buf[i], std::memory_order_relaxed);
+                m_size += k;
+                if (k != n) m_truncated = true;
+                setp(m_buf, m_buf + sizeof m_buf);
+            }
+
+            std::atomic<char> * const m_p;
+            const std::size_t m_capacity;
+            std::size_t m_size;
+            bool m_truncated;
+            char m_buf[64];
+        };
+
+    }  // namespace detail
+
+
+    // An in-memory flight recorder: a fixed number of fixed-size slots used as a
+    // ring, where each new record overwrites the oldest one. Records are formatted
+    // directly into their slot and truncated to the slot size, so recording never
+    // allocates and memory use is bounded. Producers only contend on a single atomic
+    // counter; every slot is guarded by a sequence number, which lets readers detect
+    // and skip records that are being overwritten while they are read. The slots and
+    // headers are relaxed atomics, so these concurrent reads are not data races.
+    // Usage: pretty_print::flight_recorder rec(1024, 256); rec.record(x); ... rec.dump(std::cerr);
+
+    class flight_recorder
+    {
+    public:
+        struct record_header
+        {
+            std::atomic<std::uint64_t> seq;             // 2 * ticket + 1 while writing, 2 * ticket + 2 when complete
+            std::atomic<std::uint64_t> timestamp_ns;    // system_clock time since the epoch
+            std::atomic<std::uint32_t> length;
+            std::atomic<std::uint32_t> truncated;
+        };
+
+        // The slot count is rounded up to a power of two.
+
+        flight_recorder(std::size_t slots, std::size_t slot_size)
+        : m_mask(round_up(slots) - 1), m_slot_size(slot_size),
+          m_headers(new record_header[m_mask + 1]), m_data(new std::atomic<char>[(m_mask + 1) * slot_size]()),
+          m_next(0), m_dropped(0)
+        {
+            for (std::size_t i = 0; i <= m_mask; ++i)
+            {
+                m_headers[i].seq.store(0, std::memory_order_relaxed);
+                m_headers[i].timestamp_ns.store(0, std::memory_order_relaxed);
+                m_headers[i].length.store(0, std::memory_order_relaxed);
+                m_headers[i].truncated.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        flight_recorder(const flight_recorder &) = delete;
+        flight_recorder & operator=(const flight_recorder &) = delete;
+
+        // Formats x into the next slot. Returns false if the record was dropped, either
+        // because its slot was still being written by a producer one full lap behind, or
+        // because a producer with a later ticket has already completed the slot.
+
+        template <typename T>
+        bool record(const T & x)
+        {
+            const std::uint64_t ticket = m_next.fetch_add(1, std::memory_order_relaxed);
+            record_header & h = m_headers[ticket & m_mask];
+
+            // Acquire on success, so that this producer's writes to the slot happen after
+            // those of the slot's previous producer.
+            std::uint64_t seq = h.seq.load(std::memory_order_relaxed);
+            do
+            {
+                if ((seq & 1) != 0 || seq >= 2 * ticket + 1)
+                {
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+            }
+            while (!h.seq.compare_exchange_weak(seq, 2 * ticket + 1, std::memory_order_acquire, std::memory_order_relaxed));
+            std::atomic_thread_fence(std::memory_order_release);
+
+            detail::atomic_slot_streambuf buf(slot(ticket), m_slot_size);
+            std::ostream os(&buf);
+            os << x;
+            buf.finish();
+
+            h.timestamp_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+            h.length.store(static_cast<std::uint32_t>(buf.size()), std::memory_order_relaxed);
+            h.truncated.store(buf.truncated(), std::memory_order_relaxed);
+
+            h.seq.store(2 * ticket + 2, std::memory_order_release);
+            return true;
+        }
+
+        std::uint64_t dropped() const
+        {
+            return m_dropped.load(std::memory_order_relaxed);
+        }
+
+        // Calls f(timestamp_ns, text, length, truncated) for every complete record, oldest
+        // first. The text is copied out of the slot before it is validated, so f only sees
+        // consistent records even while producers keep writing.
+
+        template <typename F>
+        void for_each(F f) const
+        {
+            std::unique_ptr<char[]> copy(new char[m_slot_size]);
+
+            const std::uint64_t end = m_next.load(std::memory_order_acquire);
+            const std::uint64_t capacity = m_mask + 1;
+
+            for (std::uint64_t ticket = end > capacity ? end - capacity : 0; ticket != end; ++ticket)
+            {
+                const record_header & h = m_headers[ticket & m_mask];
+
+                if (h.seq.load(std::memory_order_acquire) != 2 * ticket + 2) continue;
+
+                const std::uint64_t timestamp = h.timestamp_ns.load(std::memory_order_relaxed);
+                const std::uint32_t length = h.length.load(std::memory_order_relaxed);
+                const bool truncated = h.truncated.load(std::memory_order_relaxed) != 0;
+                copy_out(copy.get(), slot(ticket), length);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (h.seq.load(std::memory_order_relaxed) != 2 * ticket + 2) continue;
+
+                f(timestamp, static_cast<const char *>(copy.get()), static_cast<std::size_t>(length), truncated);
+            }
+        }
+
+        // Writes all records as lines of the form "<timestamp_ns> <text>".
+
+        void dump(std::ostream & os) const
+        {
+            for_each([&os](std::uint64_t timestamp, const char * text, std::size_t length, bool truncated)
+            {
+                os << timestamp << ' ';
+                os.write(text, length);
+                os << (truncated ? "...\n" : "\n");
+            });
+        }
+
+        // Like dump(std::ostream &), but only uses write(2) and no allocation, so it may be
+        // called from a crash handler. Records modified during the dump are marked as torn.
+
+        void dump(int fd) const
+        {
+            const std::uint64_t end = m_next.load(std::memory_order_acquire);
+            const std::uint64_t capacity = m_mask + 1;
+
+            for (std::uint64_t ticket = end > capacity ? end - capacity : 0; ticket != end; ++ticket)
+            {
+                const record_header & h = m_headers[ticket & m_mask];
+
+                if (h.seq.load(std::memory_order_acquire) != 2 * ticket + 2) continue;
+
+                char digits[24];
+                char * p = digits + sizeof digits;
+                *--p = ' ';
+                std::uint64_t t = h.timestamp_ns.load(std::memory_order_relaxed);
+                do { *--p = char('0' + t % 10); t /= 10; } while (t != 0);
+
+                write_all(fd, p, digits + sizeof digits - p);
+
+                const std::size_t length = h.length.load(std::memory_order_relaxed);
+                char chunk[256];
+                for (std::size_t i = 0; i < length; i += sizeof chunk)
+                {
+                    const std::size_t k = length - i < sizeof chunk ? length - i : sizeof chunk;
+                    copy_out(chunk, slot(ticket) + i, k);
+                    write_all(fd, chunk, k);
+                }
+                if (h.truncated.load(std::memory_order_relaxed)) write_all(fd, "...", 3);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (h.seq.load(std::memory_order_relaxed) != 2 * ticket + 2) write_all(fd, " [torn]", 7);
+                write_all(fd, "\n", 1);
+            }
+        }
+
+    private:
+        static std::size_t round_up(std::size_t n)
+        {
+            std::size_t r = 1;
+            while (r < n) r <<= 1;
+            return r;
+        }
+
+        static void write_all(int fd, const char * p, std::size_t n)
+        {
+            while (n != 0)
+            {
+                const ::ssize_t k = ::write(fd, p, n);
+                if (k < 0 && errno == EINTR) continue;
+                if (k <= 0) return;
+                p += k;
+                n -= static_cast<std::size_t>(k);
+            }
+        }
+
+        static void copy_out(char * to, const std::atomic<char> * from, std::size_t n)
+        {
+            for (std::size_t i = 0; i != n; ++i) to[i] = from[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic<char> * slot(std::uint64_t ticket) const
+        {
+            return m_data.get() + (ticket & m_mask) * m_slot_size;
+        }
+
+        const std::size_t m_mask;
+        const std::size_t m_slot_size;
+        const std::unique_ptr<record_header[]> m_headers;
+        const std::unique_ptr<std::atomic<char>[]> m_data;
+        std::atomic<std::uint64_t> m_next;
+        std::atomic<std::uint64_t> m_dropped;
+    };
+
+
+    namespace detail
+    {
+        // Layout of a shared-memory channel segment: this header, followed by the
+        // data ring at offset data_offset. Records are 8-aligned and consist of a
+        // shm_record_header followed by the text, which may wrap around the ring.
+        // A header never wraps; if fewer than sizeof(shm_record_header) bytes are
+        // left before the end of the ring, the record starts at the beginning.
+
+        struct shm_channel_layout
+        {
+            static const std::uint64_t magic_value = 0x7070636872696e67ULL;   // "ppchring"
+            static const std::size_t data_offset = 64;
+
+            std::atomic<std::uint64_t> magic;
+            std::uint64_t capacity;
+            std::atomic<std::uint64_t> head;           // end of the last complete record
+            std::atomic<std::uint64_t> reserved;       // end of the region the producer may be writing
+            std::atomic<std::uint64_t> last_record;    // start of the last complete record
+        };
+
+        struct shm_record_header
+        {
+            std::uint64_t seq;
+            std::uint32_t length;
+            std::uint32_t truncated;
+        };
+
+        inline std::uint64_t shm_record_start(std::uint64_t pos, std::uint64_t capacity)
+        {
+            pos = (pos + 7) & ~std::uint64_t(7);
+            const std::uint64_t room = capacity - pos % capacity;
+            return room < sizeof(shm_record_header) ? pos + room : pos;
+        }
+
+        // Writes into the ring in windows of at most window_size bytes, announcing each
+        // window to readers before touching it. Stops accepting text at max_length.
+
+        struct shm_ring_streambuf : std::streambuf
+        {
+            static const std::size_t window_size = 4096;
+
+            shm_ring_streambuf(shm_channel_layout * layout, char * ring, std::uint64_t pos, std::size_t max_length)
+            : m_layout(layout), m_ring(ring), m_start(pos), m_pos(pos), m_max_end(pos + max_length), m_truncated(false)
+            {
+                open_window();
+            }
+
+            std::size_t size() const { return static_cast<std::size_t>(m_pos + (pptr() - pbase()) - m_start); }
+            bool truncated() const { return m_truncated; }
+
+        protected:
+            int_type overflow(int_type c)
+            {
+                if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+
+                m_pos += pptr() - pbase();
+
+                if (m_pos == m_max_end)
+                {
+                    setp(nullptr, nullptr);
+                    m_truncated = true;
+                    return traits_type::eof();
+                }
+
+                open_window();
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+                return c;
+            }
+
+        private:
+            void open_window()
+            {
+                const std::uint64_t capacity = m_layout->capacity;
+                std::uint64_t n = capacity - m_pos % capacity;
+                if (n > window_size) n = window_size;
+                if (n > m_max_end - m_pos) n = m_max_end - m_pos;
+
+                m_layout->reserved.store(m_pos + n, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+
+                char * const p = m_ring + m_pos % capacity;
+                setp(p, p + n);
+            }
+
+            shm_channel_layout * const m_layout;
+            char * const m_ring;
+            const std::uint64_t m_start;
+            std::uint64_t m_pos;
+            const std::uint64_t m_max_end;
+            bool m_truncated;
+        };
+
+    }  // namespace detail
+
+
+    // A POSIX shared-memory channel through which a process publishes formatted
+    // snapshots to an external viewer (see ppviewer.cpp). The producer never makes
+    // a system call or signals anybody after construction: it formats straight into
+    // a byte ring in the segment and then publishes the new head. Readers that fall
+    // behind by more than the ring size skip ahead to the newest record. A single
+    // record is truncated to half the ring size. Only one producer may publish.
+    // Usage: pretty_print::shm_channel ch("/myservice", 1 << 20); ch.publish(x);
+
+    class shm_channel
+    {
+    public:
+        shm_channel(const char * name, std::size_t capacity)
+        : m_name(name), m_layout(nullptr), m_size(0), m_pos(0), m_seq(0)
+        {
+            capacity = (capacity + 7) & ~std::size_t(7);
+
+            const int fd = ::shm_open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) return;
+
+            const std::size_t size = detail::shm_channel_layout::data_offset + capacity;
+            void * p = ::ftruncate(fd, static_cast<::off_t>(size)) == 0
+                     ? ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                     : MAP_FAILED;
+            ::close(fd);
+
+            if (p == MAP_FAILED)
+            {
+                ::shm_unlink(name);
+                return;
+            }
+
+            m_size = size;
+            m_layout = new (p) detail::shm_channel_layout;
+            m_layout->capacity = capacity;
+            m_layout->head.store(0, std::memory_order_relaxed);
+            m_layout->reserved.store(0, std::memory_order_relaxed);
+            m_layout->last_record.store(0, std::memory_order_relaxed);
+            m_layout->magic.store(detail::shm_channel_layout::magic_value, std::memory_order_release);
+        }
+
+        shm_channel(const shm_channel &) = delete;
+        shm_channel & operator=(const shm_channel &) = delete;
+
+        // Unmaps and removes the segment; attached readers keep their mapping.
+
+        ~shm_channel()
+        {
+            if (!is_open()) return;
+
+            ::munmap(m_layout, m_size);
+            ::shm_unlink(m_name.c_str());
+        }
+
+        bool is_open() const
+        {
+            return m_layout != nullptr;
+        }
+
+        template <typename T>
+        void publish(const T & x)
+        {
+            if (!is_open()) return;
+
+            const std::uint64_t capacity = m_layout->capacity;
+            const std::uint64_t start = detail::shm_record_start(m_pos, capacity);
+            const std::uint64_t text = start + sizeof(detail::shm_record_header);
+
+            m_layout->reserved.store(text, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            detail::shm_ring_streambuf buf(m_layout, ring(), text, static_cast<std::size_t>(capacity / 2));
+            std::ostream os(&buf);
+            os << x;
+            os.flush();
+
+            detail::shm_record_header h;
+            h.seq = ++m_seq;
+            h.length = static_cast<std::uint32_t>(buf.size());
+            h.truncated = buf.truncated();
+            std::memcpy(ring() + start % capacity, &h, sizeof h);
+
+            m_pos = text + h.length;
+            m_layout->last_record.store(start, std::memory_order_relaxed);
+            m_layout->head.store(m_pos, std::memory_order_release);
+        }
+
+    private:
+        char * ring() const
+        {
+            return reinterpret_cast<char *>(m_layout) + detail::shm_channel_layout::data_offset;
+        }
+
+        const std::string m_name;
+        detail::shm_channel_layout * m_layout;
+        std::size_t m_size;
+        std::uint64_t m_pos;
+        std::uint64_t m_seq;
+    };
+
+
+    // The reading end of a shm_channel, for use in the viewer process.
+    // Usage: pretty_print::shm_channel_reader r("/myservice"); std::string s; while (r.next(s)) use(s);
+
+    class shm_channel_reader
+    {
+    public:
+        explicit shm_channel_reader(const char * name)
+        : m_layout(nullptr), m_size(0), m_pos(0), m_seq(0), m_lost(0)
+        {
+            const int fd = ::shm_open(name, O_RDONLY, 0);
+            if (fd < 0) return;
+
+            struct ::stat st;
+            void * p = ::fstat(fd, &st) == 0 && st.st_size > ::off_t(detail::shm_channel_layout::data_offset)
+                     ? ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0)
+                     : MAP_FAILED;
+            ::close(fd);
+
+            if (p == MAP_FAILED) return;
+
+            m_size = static_cast<std::size_t>(st.st_size);
+            m_layout = static_cast<const detail::shm_channel_layout *>(p);
+
+            if (m_layout->magic.load(std::memory_order_acquire) != detail::shm_channel_layout::magic_value)
+            {
+                ::munmap(p, m_size);
+                m_layout = nullptr;
+                return;
+            }
+
+            m_pos = m_layout->last_record.load(std::memory_order_acquire);
+        }
+
+        shm_channel_reader(const shm_channel_reader &) = delete;
+        shm_channel_reader & operator=(const shm_channel_reader &) = delete;
+
+        ~shm_channel_reader()
+        {
+            if (is_open()) ::munmap(const_cast<detail::shm_channel_layout *>(m_layout), m_size);
+        }
+
+        bool is_open() const
+        {
+            return m_layout != nullptr;
+        }
+
+        // The number of records skipped because the producer overtook this reader.
+
+        std::uint64_t lost() const
+        {
+            return m_lost;
+        }
+
+        // Copies the next record into s; returns false if there is no new record yet.
+
+        bool next(std::string & s, bool * truncated = nullptr)
+        {
+            if (!is_open()) return false;
+
+            const std::uint64_t capacity = m_layout->capacity;
+
+            for ( ; ; )
+            {
+                const std::uint64_t head = m_layout->head.load(std::memory_order_acquire);
+                if (m_pos >= head) return false;
+
+                const std::uint64_t start = detail::shm_record_start(m_pos, capacity);
+
+                detail::shm_record_header h;
+                std::memcpy(&h, ring() + start % capacity, sizeof h);
+
+                const std::uint64_t text = start + sizeof h;
+                if (h.length <= capacity / 2)
+                {
+                    s.resize(h.length);
+                    const std::size_t first = static_cast<std::size_t>(
+                        h.length < capacity - text % capacity ? h.length : capacity - text % capacity);
+                    std::memcpy(&s[0], ring() + text % capacity, first);
+                    std::memcpy(&s[0] + first, ring(), h.length - first);
+                }
+
+                // The copy is only valid if the producer has not reached it since.
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (h.length > capacity / 2 || m_layout->reserved.load(std::memory_order_relaxed) > start + capacity)
+                {
+                    m_pos = m_layout->last_record.load(std::memory_order_acquire);
+                    continue;
+                }
+
+                if (m_seq != 0 && h.seq > m_seq + 1) m_lost += h.seq - m_seq - 1;
+                m_seq = h.seq;
+
+                if (truncated != nullptr) *truncated = h.truncated != 0;
+                m_pos = text + h.length;
+                return true;
+            }
+        }
+
+    private:
+        const char * ring() const
+        {
+            return reinterpret_cast<const char *>(m_layout) + detail::shm_channel_layout::data_offset;
+        }
+
+        const detail::shm_channel_layout * m_layout;
+        std::size_t m_size;
+        std::uint64_t m_pos;
+        std::uint64_t m_seq;
+        std::uint64_t m_lost;
+    };
+
+}   // namespace pretty_print
+
+#endif  // H_PRETTY_PRINT_SINKS
@@ -0,0 +1,27 @@
+//          Copyright Louis Delacroix 2010 - 2014.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+//
+// Printing of std::valarray for prettyprint_core.hpp.
+//
+// Usage:
+// #include "prettyprint_valarray.hpp" and std::valarray prints as "[a, b, c]".
+
+#ifndef H_PRETTY_PRINT_VALARRAY
+#define H_PRETTY_PRINT_VALARRAY
+
+#include "prettyprint_core.hpp"
+
+#include <valarray>
+
+namespace pretty_print
+{
+    // valarray has no const_iterator, but std::begin and std::end work on it.
+
+    template <typename T>
+    struct is_container<std::valarray<T>> : std::true_type { };
+
+}   // namespace pretty_print
+
+#endif  // H_PRETTY_PRINT_VALARRAY